@@ -4,34 +4,40 @@
 #include "database.h"
 #include "load_test_data.h"
 #include "file_io.h"
+#include "connection.h"
+#include "dict.h"
+#include "question_cache.h"
+#include "quiz_sample.h"
+#include "roster.h"
+#include "search.h"
 
-char current_user_uuid[37] = {0};
-char current_username[100] = {0};
-char current_user_class[50] = {0};
-int current_user_num = 0;
-int current_user_level = -1;
+/* 当前登录用户的资料，登录时一次查出，会话期间不再查询 users；未登录时 uuid 为空串 */
+struct UserProfile current_user = {.level = -1};
 
 /**
  * @brief 显示主菜单
  */
 void show_main_menu() {
     printf("\n");
-    if (current_user_uuid[0] == '\0') {
+    if (current_user.uuid[0] == '\0') {
         printf("====== Vocabulary Scale ======\n");
         printf("1. 注册\n");
         printf("2. 登录\n");
         printf("0. 退出\n");
     } else {
-        printf("欢迎，%s（等级 %d）\n", current_username, current_user_level);
+        printf("欢迎，%s（等级 %d）\n", current_user.username, current_user.level);
         printf("2. 注销\n");
         printf("3. 删除账户\n");
-        if (current_user_level <= 1) {
+        if (current_user.level <= 1) {
             printf("4. 题目管理\n");
             printf("5. 按 姓名 / 学号 / 班级 查询成绩\n");
             printf("6. 按班级输出统计数据\n");
                 printf("7. 文件导出\n");
         }
-        if (current_user_level == 2) {
+        if (current_user.level == 0) {
+            printf("8. 批量删除学生\n");
+        }
+        if (current_user.level == 2) {
             printf("4. 开始测验\n");
             printf("5. 查看我的成绩\n");
         }
@@ -93,14 +99,8 @@ void login_user() {
     fgets(password, sizeof(password), stdin);
     password[strcspn(password, "\r\n")] = 0;
     
-    char* uuid = loginUser(username, password);
-    if (uuid) {
-        int level = getUserLevel(uuid);
-        strncpy(current_user_uuid, uuid, 36);
-        strncpy(current_username, username, 99);
-        current_user_level = level;
-        printf("[成功] 登录成功（等级 %d）\n", level);
-        free(uuid);
+    if (loginUserProfile(username, password, &current_user)) {
+        printf("[成功] 登录成功（等级 %d）\n", current_user.level);
     } else {
         printf("[错误] 登录失败\n");
     }
@@ -110,12 +110,76 @@ void login_user() {
  * @brief 用户登出
  */
 void logout_user() {
-    memset(current_user_uuid, 0, 37);
-    memset(current_username, 0, 100);
-    current_user_level = -1;
+    memset(&current_user, 0, sizeof(current_user));
+    current_user.level = -1;
     printf("[成功] 已注销\n");
 }
 
+/**
+ * @brief 读取一行整数，直接回车时返回 0
+ */
+static int read_optional_int(void) {
+    char line[32];
+    if (!fgets(line, sizeof(line), stdin)) return 0;
+    return atoi(line);
+}
+
+/**
+ * @brief 按词性与单词长度筛选后导入 CET4 词库
+ */
+static void import_dict_menu(void) {
+    char pos[16];
+    struct DictFilter filter = {NULL, 0, 0, 1, 0};
+    
+    printf("词性（如 n. v. adj.，直接回车不限）：");
+    fgets(pos, sizeof(pos), stdin);
+    pos[strcspn(pos, "\r\n")] = 0;
+    if (pos[0]) filter.pos = pos;
+    printf("单词最短长度（直接回车不限）：");
+    filter.min_len = read_optional_int();
+    printf("单词最长长度（直接回车不限）：");
+    filter.max_len = read_optional_int();
+    printf("最多导入数量（直接回车不限）：");
+    filter.limit = read_optional_int();
+    
+    struct ImportStats st;
+    if (importDictQuestions(DICT_NAME, &filter, &st)) {
+        printf("[成功] 新增 %d 个题目，%d 个已在题库中\n", st.inserted, st.skipped);
+    }
+}
+
+/* 搜索结果最多显示的条数 */
+#define SEARCH_SHOW_LIMIT 50
+
+/**
+ * @brief 在题库或 CET4 词库中按前缀、包含或翻译搜索单词
+ */
+static void search_menu(void) {
+    char query[100];
+    printf("范围（1. 题库  2. CET4 词库）：");
+    enum SearchSource source = read_optional_int() == 2 ? SEARCH_DICT : SEARCH_QUESTIONS;
+    printf("方式（1. 单词开头  2. 单词包含  3. 按翻译反查）：");
+    int mode = read_optional_int();
+    printf("关键字：");
+    fgets(query, sizeof(query), stdin);
+    query[strcspn(query, "\r\n")] = 0;
+    
+    struct QuestionSet found;
+    questionSetInit(&found);
+    int n = searchWords(source, mode == 3 ? SEARCH_TRANSLATION : mode == 2 ? SEARCH_SUBSTRING : SEARCH_PREFIX,
+                        query, SEARCH_SHOW_LIMIT, &found);
+    if (n > 0) {
+        printf("\n=== 搜索结果（最多显示 %d 个） ===\n", SEARCH_SHOW_LIMIT);
+        printf("%-5s %-25s %-50s\n", "编号", "英文", "翻译");
+        for (int i = 0; i < found.count; i++) {
+            printf("%-5d %-25s %-50s\n", found.qids[i], questionSetWord(&found, i), questionSetTranslate(&found, i));
+        }
+    } else if (n == 0) {
+        printf("[提示] 没有匹配的单词\n");
+    }
+    questionSetFree(&found);
+}
+
 /**
  * @brief 题目管理菜单
  */
@@ -128,6 +192,10 @@ void manage_questions_menu() {
         printf("3. 删除单个题目\n");
         printf("4. 删除所有题目\n");
         printf("5. 查看所有题目\n");
+        printf("6. 从 dict.db 导入 CET4 词库\n");
+        printf("7. 在 CET4 词库中查词\n");
+        printf("8. 按答题记录重新计算题目难度\n");
+        printf("9. 搜索单词\n");
         printf("0. 返回\n");
         printf("选择：");
         scanf("%d", &subchoice);
@@ -157,24 +225,96 @@ void manage_questions_menu() {
                 printf("[成功] 删除成功\n");
             }
         } else if (subchoice == 5) {
-            int count = 0;
-            struct Question* q = getQuestions(&count);
-            if (q && count > 0) {
-                printf("\n=== 所有题目（%d） ===\n", count);
+            const struct QuestionSet* q = questionCacheGet();
+            if (q && q->count > 0) {
+                printf("\n=== 所有题目（%d） ===\n", q->count);
                 printf("%-5s %-25s %-50s\n", "编号", "英文", "翻译");
-                for (int i = 0; i < count; i++) {
-                    printf("%-5d %-25s %-50s\n", q[i].qid, q[i].word, q[i].translate);
+                for (int i = 0; i < q->count; i++) {
+                    printf("%-5d %-25s %-50s\n", q->qids[i], questionSetWord(q, i), questionSetTranslate(q, i));
                 }
-                free(q);
             } else {
                 printf("[提示] 无题目\n");
             }
+        } else if (subchoice == 6) {
+            import_dict_menu();
+        } else if (subchoice == 7) {
+            char word[100], trans[256];
+            printf("单词（word）：");
+            fgets(word, sizeof(word), stdin);
+            word[strcspn(word, "\r\n")] = 0;
+            
+            if (dictOpen(DICT_NAME)) {
+                if (dictLookup(word, trans, sizeof(trans))) {
+                    printf("%s  %s\n", word, trans);
+                } else {
+                    printf("[提示] 词库中没有该单词\n");
+                }
+            }
+        } else if (subchoice == 8) {
+            recomputeDifficulty(DIFFICULTY_MIN_ANSWERS);
+        } else if (subchoice == 9) {
+            search_menu();
         } else if (subchoice == 0) {
             break;
         }
     }
 }
 
+/* 成绩查询每页显示的行数 */
+#define GRADE_PAGE_SIZE 20
+
+enum GradeQueryType { QUERY_BY_NAME, QUERY_BY_CLASS, QUERY_BY_NUM_RANGE };
+
+struct GradeQuery {
+    enum GradeQueryType type;
+    char text[100];     /* 姓名或班级 */
+    int min_num;
+    int max_num;
+    enum NameMatch match;   /* 按姓名查询时的匹配方式 */
+};
+
+/**
+ * @brief 成绩回调：首行前打印表头，之后逐行输出
+ */
+static int print_grade_row(const struct GradeRow* row, void* ctx) {
+    int* printed = (int*)ctx;
+    if ((*printed)++ == 0) {
+        printf("\n=== 结果 ===\n");
+        printf("%-20s %-15s %-10s %-10s %-10s\n", "姓名", "班级", "学号", "成绩", "正确率");
+    }
+    printf("%-20s %-15s %-10d %-10d %-10.1f%%\n", 
+        row->username, row->class_name, row->student_num, 
+        row->total_score, row->accuracy * 100);
+    return 0;
+}
+
+/**
+ * @brief 分页查询成绩，每页从数据库读出后立即输出
+ */
+static void show_grades_paged(const struct GradeQuery* q) {
+    int printed = 0;
+    while (1) {
+        int rows;
+        if (q->type == QUERY_BY_NAME) {
+            rows = forEachGradeByNameMatch(q->text, q->match, GRADE_PAGE_SIZE, printed, print_grade_row, &printed);
+        } else if (q->type == QUERY_BY_CLASS) {
+            rows = forEachGradeByClass(q->text, GRADE_PAGE_SIZE, printed, print_grade_row, &printed);
+        } else {
+            rows = forEachGradeByStudentNumRange(q->min_num, q->max_num, GRADE_PAGE_SIZE, printed, print_grade_row, &printed);
+        }
+        
+        if (printed == 0) {
+            printf("[提示] 无结果\n");
+            return;
+        }
+        if (rows < GRADE_PAGE_SIZE) return;
+        
+        char line[16];
+        printf("-- 已显示 %d 条，回车查看下一页，输入 q 返回 --", printed);
+        if (!fgets(line, sizeof(line), stdin) || line[0] == 'q' || line[0] == 'Q') return;
+    }
+}
+
 /**
  * @brief 查询成绩菜单
  */
@@ -191,67 +331,28 @@ void query_grades_menu() {
         getchar();
         
         if (subchoice == 1) {
-            char name[100];
+            struct GradeQuery q = {.type = QUERY_BY_NAME, .match = NAME_MATCH_SUBSTRING};
+            printf("匹配方式（1. 包含  2. 开头  3. 完全相同，直接回车为包含）：");
+            int match = read_optional_int();
+            q.match = match == 3 ? NAME_MATCH_EXACT : match == 2 ? NAME_MATCH_PREFIX : NAME_MATCH_SUBSTRING;
             printf("学生姓名：");
-            fgets(name, sizeof(name), stdin);
-            name[strcspn(name, "\r\n")] = 0;
-            
-            int count = 0;
-            struct GradeInfo* grades = getGradesByName(name, &count);
-            if (grades && count > 0) {
-                printf("\n=== 结果 ===\n");
-                printf("%-20s %-15s %-10s %-10s %-10s\n", "姓名", "班级", "学号", "成绩", "正确率");
-                for (int i = 0; i < count; i++) {
-                    printf("%-20s %-15s %-10d %-10d %-10.1f%%\n", 
-                        grades[i].username, grades[i].class_name, grades[i].student_num, 
-                        grades[i].total_score, grades[i].accuracy * 100);
-                }
-                free(grades);
-            } else {
-                printf("[提示] 无结果\n");
-            }
+            fgets(q.text, sizeof(q.text), stdin);
+            q.text[strcspn(q.text, "\r\n")] = 0;
+            show_grades_paged(&q);
         } else if (subchoice == 2) {
-            char classname[50];
+            struct GradeQuery q = {.type = QUERY_BY_CLASS};
             printf("班级名称：");
-            fgets(classname, sizeof(classname), stdin);
-            classname[strcspn(classname, "\r\n")] = 0;
-            
-            int count = 0;
-            struct GradeInfo* grades = getGradesByClass(classname, &count);
-            if (grades && count > 0) {
-                printf("\n=== 结果 ===\n");
-                printf("%-20s %-15s %-10s %-10s %-10s\n", "姓名", "班级", "学号", "成绩", "正确率");
-                for (int i = 0; i < count; i++) {
-                    printf("%-20s %-15s %-10d %-10d %-10.1f%%\n", 
-                        grades[i].username, grades[i].class_name, grades[i].student_num, 
-                        grades[i].total_score, grades[i].accuracy * 100);
-                }
-                free(grades);
-            } else {
-                printf("[提示] 无结果\n");
-            }
+            fgets(q.text, sizeof(q.text), stdin);
+            q.text[strcspn(q.text, "\r\n")] = 0;
+            show_grades_paged(&q);
         } else if (subchoice == 3) {
-            int min, max;
+            struct GradeQuery q = {.type = QUERY_BY_NUM_RANGE};
             printf("最小学号：");
-            scanf("%d", &min);
+            scanf("%d", &q.min_num);
             printf("最大学号：");
-            scanf("%d", &max);
+            scanf("%d", &q.max_num);
             getchar();
-            
-            int count = 0;
-            struct GradeInfo* grades = getGradesByStudentNumRange(min, max, &count);
-            if (grades && count > 0) {
-                printf("\n=== 结果 ===\n");
-                printf("%-20s %-15s %-10s %-10s %-10s\n", "姓名", "班级", "学号", "成绩", "正确率");
-                for (int i = 0; i < count; i++) {
-                    printf("%-20s %-15s %-10d %-10d %-10.1f%%\n", 
-                        grades[i].username, grades[i].class_name, grades[i].student_num, 
-                        grades[i].total_score, grades[i].accuracy * 100);
-                }
-                free(grades);
-            } else {
-                printf("[提示] 无结果\n");
-            }
+            show_grades_paged(&q);
         } else if (subchoice == 0) {
             break;
         }
@@ -318,22 +419,103 @@ void file_export_menu() {
     }
 }
 
-int main() {
+/**
+ * @brief 批量删除学生菜单（仅管理员）：按班级或学号范围删除学生及其答题记录
+ */
+void delete_students_menu() {
+    int subchoice;
+    printf("\n=== 批量删除学生 ===\n");
+    printf("1. 按班级删除\n");
+    printf("2. 按学号范围删除\n");
+    printf("0. 返回\n");
+    printf("选择：");
+    if (scanf("%d", &subchoice) != 1) subchoice = -1;
+    getchar();
+    
+    char classname[50];
+    int min_num = 0, max_num = 0;
+    if (subchoice == 1) {
+        printf("班级名称：");
+        fgets(classname, sizeof(classname), stdin);
+        classname[strcspn(classname, "\r\n")] = 0;
+    } else if (subchoice == 2) {
+        printf("最小学号：");
+        scanf("%d", &min_num);
+        printf("最大学号：");
+        scanf("%d", &max_num);
+        getchar();
+    } else {
+        if (subchoice != 0) printf("[错误] 无效选择\n");
+        return;
+    }
+    
+    printf("学生的答题记录将一并删除，确认删除？(y/n)：");
+    char confirm[8];
+    if (!fgets(confirm, sizeof(confirm), stdin) || (confirm[0] != 'y' && confirm[0] != 'Y')) {
+        printf("[提示] 已取消\n");
+        return;
+    }
+    int deleted = subchoice == 1 ? deleteUsersByClass(classname) : deleteUsersByStudentNumRange(min_num, max_num);
+    if (deleted >= 0) {
+        printf("[成功] 已删除 %d 名学生\n", deleted);
+    } else {
+        printf("[错误] 删除失败\n");
+    }
+}
+
+/* 启动参数 --rebuild-stats：打开数据库后重建成绩汇总表 */
+static int opt_rebuild_stats = 0;
+/* --generate=班级数,每班学生数,题目数,每人答题数 与 --seed=N：生成合成数据后退出 */
+static int opt_generate = 0;
+static struct SyntheticSpec opt_spec = {0, 0, 0, 0, 20, 70, 20, 1, 42};
+/* --import-roster=名单.csv：按 CSV 名单批量创建用户后退出 */
+static const char* opt_roster = NULL;
+
+/**
+ * @brief 解析命令行参数
+ * 支持 --profile=safe|balanced|fast（也可通过环境变量 VOCAB_DB_PROFILE 指定）与 --rebuild-stats
+ */
+static void parse_args(int argc, char** argv) {
+    const char* profile = getenv("VOCAB_DB_PROFILE");
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--profile=", 10) == 0) {
+            profile = argv[i] + 10;
+        } else if (strcmp(argv[i], "--rebuild-stats") == 0) {
+            opt_rebuild_stats = 1;
+        } else if (strncmp(argv[i], "--generate=", 11) == 0) {
+            opt_generate = sscanf(argv[i] + 11, "%d,%d,%d,%d", &opt_spec.classes, &opt_spec.students_per_class,
+                                  &opt_spec.questions, &opt_spec.answers_per_student) == 4;
+            if (!opt_generate) fprintf(stderr, "[WARN] 格式应为 --generate=班级数,每班学生数,题目数,每人答题数\n");
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            opt_spec.seed = strtoull(argv[i] + 7, NULL, 10);
+        } else if (strncmp(argv[i], "--import-roster=", 16) == 0) {
+            opt_roster = argv[i] + 16;
+        }
+    }
+    if (profile && !dbSetProfile(profile)) {
+        fprintf(stderr, "[WARN] 使用默认配置 %s\n", dbProfileName());
+    }
+}
+
+int main(int argc, char** argv) {
     int choice;
     printf("\n====== Vocabulary Scale ======\n");
-    /* 在程序启动时初始化数据库表结构（迁移后的 initDatabase 在 load_test_data.c 中实现） */
-    {
-        sqlite3 *db = NULL;
-        int rc = sqlite3_open("vocab_system.db", &db);
-        if (rc != SQLITE_OK) {
-            fprintf(stderr, "[ERROR] Cannot open database to init: %s\n", sqlite3_errmsg(db));
-            if (db) sqlite3_close(db);
-        } else {
-            if (!initDatabase(db)) {
-                fprintf(stderr, "[ERROR] initDatabase failed\n");
-            }
-            sqlite3_close(db);
-        }
+    parse_args(argc, argv);
+    /* 在程序启动时打开共享连接并初始化数据库表结构，此后所有操作复用该连接 */
+    if (!dbOpen(DB_NAME)) {
+        fprintf(stderr, "[ERROR] Cannot open database to init\n");
+    } else if (opt_rebuild_stats) {
+        rebuildStudentStats();
+    }
+    if (opt_generate) {
+        int ok = load_synthetic_data(&opt_spec);
+        dbClose();
+        return ok ? 0 : 1;
+    }
+    if (opt_roster) {
+        int created = rosterImport(opt_roster);
+        dbClose();
+        return created >= 0 ? 0 : 1;
     }
 
     /* 启动时自动加载测试数据（如果需要可在 load_test_user_data 中做存在性检查） */
@@ -350,7 +532,7 @@ int main() {
         }
         getchar();
         
-        if (current_user_uuid[0] == '\0') {
+        if (current_user.uuid[0] == '\0') {
             if (choice == 1) {
                 register_user();
             } else if (choice == 2) {
@@ -366,25 +548,31 @@ int main() {
             } else if (choice == 2) {
                 logout_user();
             } else if (choice == 3) {
-                if (deleteUser(current_user_uuid)) {
+                if (deleteUser(current_user.uuid)) {
                     logout_user();
                 }
-            } else if (choice == 4 && current_user_level <= 1) {
+            } else if (choice == 4 && current_user.level <= 1) {
                 manage_questions_menu();
-            } else if (choice == 5 && current_user_level <= 1) {
+            } else if (choice == 5 && current_user.level <= 1) {
                 query_grades_menu();
-            } else if (choice == 6 && current_user_level <= 1) {
+            } else if (choice == 6 && current_user.level <= 1) {
                 statistics_menu();
-            } else if (choice == 7 && current_user_level <= 1) {
+            } else if (choice == 7 && current_user.level <= 1) {
                 file_export_menu();
-            } else if (choice == 4 && current_user_level == 2) {
-                int score = startQuiz(current_user_uuid, current_username, current_user_class, current_user_num);
+            } else if (choice == 8 && current_user.level == 0) {
+                delete_students_menu();
+            } else if (choice == 4 && current_user.level == 2) {
+                struct QuizOptions options = {.size = 0, .sampling = QUIZ_SAMPLE_REVIEW};
+                printf("题目数量（直接回车为 %d）：", QUIZ_DEFAULT_SIZE);
+                options.size = read_optional_int();
+                int score = startQuizWithOptions(current_user.uuid, current_user.username, current_user.class_name,
+                                                 current_user.student_num, &options);
                 /* 答题完成后，自动将成绩追加到 stu.txt */
-                addStuGradeToFile("stu.txt", current_user_uuid, current_username, 
-                                        current_user_class, current_user_num, score);
-            } else if (choice == 5 && current_user_level == 2) {
+                addStuGradeToFile("stu.txt", current_user.uuid, current_user.username, 
+                                        current_user.class_name, current_user.student_num, score);
+            } else if (choice == 5 && current_user.level == 2) {
                 int count = 0;
-                struct GradeInfo* grades = getGradesByName(current_username, &count);
+                struct GradeInfo* grades = getGradesByNameMatch(current_user.username, NAME_MATCH_EXACT, &count);
                 if (grades && count > 0) {
                     printf("\n=== 我的成绩 ===\n");
                     printf("%-20s %-10s\n", "姓名", "成绩");
@@ -399,6 +587,8 @@ int main() {
         }
     }
     
+    dictClose();
+    dbClose();
     printf("\nbyebye~!\n");
     return 0;
 }
@@ -0,0 +1,2055 @@
+/*
+ * 性能基准测试程序，与主程序分开编译（见 README）
+ * 用法: bench [case] [iterations] [--users=N] [--questions=N] [--answers=N] [--json=FILE]
+ * --json 将每项结果以 JSON Lines 追加到 FILE，便于跟踪性能回归
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define close _close
+#define fileno _fileno
+#define NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#endif
+#include "../database.h"
+#include "../connection.h"
+#include "../dict.h"
+#include "../file_io.h"
+#include "../grading.h"
+#include "../load_test_data.h"
+#include "../migrate.h"
+#include "../question_cache.h"
+#include "../question_list.h"
+#include "../quiz_sample.h"
+#include "../review.h"
+#include "../roster.h"
+#include "../search.h"
+#include "../stmt_cache.h"
+#include "../timer.h"
+#include "../uuid.h"
+
+#define BENCH_DB "bench.db"
+#define API_DB "bench_api.db"
+
+static int iterations = 20000;
+
+/* api 用例的数据规模：学生数、题目数、每名学生的答题记录数 */
+static int seed_users = 1000;
+static int seed_questions = 500;
+static int seed_answers = 20;
+
+static FILE* json_out = NULL;
+static const char* current_case = "";
+
+/**
+ * @brief 将一项结果以 JSON 对象写成一行，sorted 为升序的单次耗时（可为 NULL）
+ */
+static void emit_json(const char* name, int n, int errors, long long ns, const long long* sorted) {
+    if (!json_out) return;
+    fprintf(json_out, "{\"case\":\"%s\",\"name\":\"%s\",\"profile\":\"%s\",\"n\":%d,\"errors\":%d,"
+            "\"ops_per_s\":%.1f,\"mean_us\":%.3f",
+            current_case, name, dbProfileName(), n, errors, n * 1e9 / ns, ns / 1e3 / n);
+    if (sorted) {
+        fprintf(json_out, ",\"p50_us\":%.3f,\"p90_us\":%.3f,\"p99_us\":%.3f,\"max_us\":%.3f",
+                sorted[n * 50 / 100] / 1e3, sorted[n * 90 / 100] / 1e3,
+                sorted[n * 99 / 100] / 1e3, sorted[n - 1] / 1e3);
+    }
+    fprintf(json_out, "}\n");
+    fflush(json_out);
+}
+
+/**
+ * @brief 输出不属于耗时的数值指标（如页数）
+ */
+static void emit_metric(const char* name, double value) {
+    if (!json_out) return;
+    fprintf(json_out, "{\"case\":\"%s\",\"name\":\"%s\",\"value\":%.3f}\n", current_case, name, value);
+    fflush(json_out);
+}
+
+static void report(const char* name, int n, long long ns) {
+    if (ns <= 0) ns = 1;
+    printf("%-32s %8d calls %12.0f calls/s %10.2f us/call\n",
+           name, n, n * 1e9 / ns, ns / 1e3 / n);
+    emit_json(name, n, 0, ns, NULL);
+}
+
+/* 逐次记录耗时，用于计算延迟分位数 */
+struct Samples {
+    long long* ns;
+    int n;
+    int errors;
+    long long total;
+};
+
+static int cmp_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 输出吞吐量与 p50 / p90 / p99 / max 延迟
+ */
+static void report_samples(const char* name, struct Samples* s) {
+    if (s->n == 0) return;
+    long long total = s->total > 0 ? s->total : 1;
+    qsort(s->ns, s->n, sizeof(long long), cmp_ll);
+    printf("%-32s %8d calls %12.0f calls/s  p50 %9.2f  p90 %9.2f  p99 %9.2f  max %9.2f us",
+           name, s->n, s->n * 1e9 / total, s->ns[s->n * 50 / 100] / 1e3, s->ns[s->n * 90 / 100] / 1e3,
+           s->ns[s->n * 99 / 100] / 1e3, s->ns[s->n - 1] / 1e3);
+    if (s->errors) printf("  errors %d", s->errors);
+    printf("\n");
+    emit_json(name, s->n, s->errors, total, s->ns);
+}
+
+/* 部分接口（statisticsByClass、文件导出）会打印到 stdout，计时期间将其重定向到空设备 */
+static int muted_stdout = -1;
+
+static void mute_stdout(void) {
+    fflush(stdout);
+    FILE* null_file = fopen(NULL_DEVICE, "w");
+    if (!null_file) return;
+    muted_stdout = dup(fileno(stdout));
+    dup2(fileno(null_file), fileno(stdout));
+    fclose(null_file);
+}
+
+static void unmute_stdout(void) {
+    if (muted_stdout < 0) return;
+    fflush(stdout);
+    dup2(muted_stdout, fileno(stdout));
+    close(muted_stdout);
+    muted_stdout = -1;
+}
+
+/**
+ * @brief 直接插入一个学生，UUID 由序号确定
+ * 重复运行时复用同一批学生，不必每次重新登录查找 UUID
+ */
+static void insert_student(int id, const char* name, const char* class_name, int num) {
+    char uuid[37];
+    snprintf(uuid, sizeof(uuid), "00000000-0000-4000-8000-%012d", id);
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(dbGet(), "INSERT OR IGNORE INTO users VALUES(?, ?, '177621', 2, ?, ?, '')", -1, &stmt, NULL) != SQLITE_OK) return;
+    uuidBind(stmt, 1, uuid);
+    sqlite3_bind_text(stmt, 2, name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, class_name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, num);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+}
+
+/**
+ * @brief 取得基准测试用户的 UUID，不存在时创建（密码为 "0"）
+ */
+static char* bench_user(void) {
+    insert_student(0, "bench_user", "1", 1);
+    return loginUser("bench_user", "0");
+}
+
+/**
+ * @brief 旧的访问方式：每次调用都打开数据库、准备语句、查询后再关闭
+ */
+static int level_with_reopen(const char* uuid) {
+    sqlite3* db;
+    if (sqlite3_open(BENCH_DB, &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        return -1;
+    }
+    sqlite3_stmt* stmt = NULL;
+    int level = -1;
+    if (sqlite3_prepare_v2(db, "SELECT user_level FROM users WHERE uuid = ?", -1, &stmt, NULL) == SQLITE_OK) {
+        uuidBind(stmt, 1, uuid);
+        if (sqlite3_step(stmt) == SQLITE_ROW) level = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return level;
+}
+
+/**
+ * @brief 对比每次调用重新打开连接与复用共享连接的吞吐量
+ */
+static int bench_conn(void) {
+    char* uuid = bench_user();
+    if (!uuid) return 1;
+
+    long long start = timerNowNs();
+    for (int i = 0; i < iterations; i++) level_with_reopen(uuid);
+    report("getUserLevel (open/close)", iterations, timerNowNs() - start);
+
+    start = timerNowNs();
+    for (int i = 0; i < iterations; i++) getUserLevel(uuid);
+    report("getUserLevel (shared handle)", iterations, timerNowNs() - start);
+
+    free(uuid);
+    return 0;
+}
+
+/**
+ * @brief 准备一个小班级（20 名学生，每人 10 条答题记录）供成绩查询使用
+ */
+static void seed_small_class(void) {
+    int count = 0;
+    struct GradeInfo* grades = getGradesByClass("bench", &count);
+    freeGrades(grades);
+    if (count > 0) return;
+
+    beginAnswerSession();
+    for (int i = 1; i <= 20; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "bench_stu%d", i);
+        insert_student(i, name, "bench", 1000 + i);
+        char* uuid = loginUser(name, "0");
+        if (!uuid) continue;
+        for (int q = 0; q < 10; q++) saveAnswerRecord(uuid, q + 1, "x", q % 2, q % 2 ? 10 : 0);
+        free(uuid);
+    }
+    endAnswerSession();
+}
+
+/**
+ * @brief 对比每次重新准备按班级查询成绩的语句与使用语句缓存
+ */
+static int bench_stmt(void) {
+    seed_small_class();
+
+    const char* sql = stmtSql(STMT_GRADES_BY_CLASS);
+    sqlite3* db = dbGet();
+    long long start = timerNowNs();
+    for (int i = 0; i < iterations; i++) {
+        sqlite3_stmt* stmt = NULL;
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) break;
+        sqlite3_bind_text(stmt, 1, "bench", -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, -1);
+        sqlite3_bind_int(stmt, 3, 0);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {}
+        sqlite3_finalize(stmt);
+    }
+    report("grades by class (prepare each)", iterations, timerNowNs() - start);
+
+    /* 清空缓存，使第一次调用计入一次未命中 */
+    stmtCacheClear();
+    stmtCacheResetStats();
+    start = timerNowNs();
+    for (int i = 0; i < iterations; i++) {
+        sqlite3_stmt* stmt = stmtGet(STMT_GRADES_BY_CLASS);
+        if (!stmt) break;
+        sqlite3_bind_text(stmt, 1, "bench", -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, -1);
+        sqlite3_bind_int(stmt, 3, 0);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {}
+        stmtRelease(stmt);
+    }
+    report("grades by class (stmt cache)", iterations, timerNowNs() - start);
+
+    struct StmtCacheStats st;
+    stmtCacheGetStats(&st);
+    printf("cache hits %lld, misses %lld, prepare time %.2f us\n",
+           st.hits, st.misses, st.prepare_ns / 1e3);
+    return 0;
+}
+
+/**
+ * @brief 对比逐条自动提交答题记录与答题会话批量提交（每轮模拟 100 题的测验）
+ */
+static int bench_quiz(void) {
+    char* uuid = bench_user();
+    if (!uuid) return 1;
+    int quizzes = iterations / 100 > 0 ? iterations / 100 : 1;
+
+    long long start = timerNowNs();
+    for (int n = 0; n < quizzes; n++) {
+        for (int q = 0; q < 100; q++) saveAnswerRecord(uuid, q + 1, "answer", q % 2, q % 2);
+    }
+    report("saveAnswerRecord (autocommit)", quizzes * 100, timerNowNs() - start);
+
+    start = timerNowNs();
+    for (int n = 0; n < quizzes; n++) {
+        beginAnswerSession();
+        for (int q = 0; q < 100; q++) saveAnswerRecord(uuid, q + 1, "answer", q % 2, q % 2);
+        endAnswerSession();
+    }
+    report("saveAnswerRecord (answer session)", quizzes * 100, timerNowNs() - start);
+
+    free(uuid);
+    return 0;
+}
+
+/**
+ * @brief 删除数据库文件及其 WAL / SHM 文件
+ */
+static void remove_db_files(const char* path) {
+    char buf[300];
+    remove(path);
+    snprintf(buf, sizeof(buf), "%s-wal", path);
+    remove(buf);
+    snprintf(buf, sizeof(buf), "%s-shm", path);
+    remove(buf);
+}
+
+/**
+ * @brief 在每个性能配置档下各用一个全新的数据库，比较答题写入与成绩查询的吞吐量
+ */
+static int bench_profiles(void) {
+    static const char* names[] = {"safe", "balanced", "fast"};
+    char restore[32];
+    snprintf(restore, sizeof(restore), "%s", dbProfileName());
+
+    for (size_t p = 0; p < sizeof(names) / sizeof(names[0]); p++) {
+        char path[64];
+        snprintf(path, sizeof(path), "bench_%s.db", names[p]);
+        dbClose();
+        remove_db_files(path);
+        dbSetProfile(names[p]);
+        if (!dbOpen(path)) continue;
+        seed_small_class();
+
+        char* uuid = bench_user();
+        if (!uuid) continue;
+        char label[64];
+        int writes = iterations / 10 > 0 ? iterations / 10 : 1;
+
+        long long start = timerNowNs();
+        for (int i = 0; i < writes; i++) saveAnswerRecord(uuid, i % 100 + 1, "answer", i % 2, i % 2);
+        snprintf(label, sizeof(label), "%s: quiz write", names[p]);
+        report(label, writes, timerNowNs() - start);
+        free(uuid);
+
+        start = timerNowNs();
+        for (int i = 0; i < iterations; i++) {
+            int count = 0;
+            freeGrades(getGradesByClass("bench", &count));
+        }
+        snprintf(label, sizeof(label), "%s: getGradesByClass", names[p]);
+        report(label, iterations, timerNowNs() - start);
+
+        dbClose();
+        remove_db_files(path);
+    }
+
+    dbSetProfile(restore);
+    return dbOpen(BENCH_DB) ? 0 : 1;
+}
+
+/**
+ * @brief 检查成绩查询的执行计划，出现全表扫描时失败
+ */
+static int bench_plans(void) {
+    if (!verifyGradeQueryPlans(dbGet())) return 1;
+    printf("all grade, name, review, paper and user delete queries use indexes\n");
+    return 0;
+}
+
+#define IMPORT_FILE "bench_timu.txt"
+#define IMPORT_LINES 100000
+
+/**
+ * @brief 写出 IMPORT_LINES 行题目文件，variant 不同时翻译不同
+ */
+static int write_import_file(int variant) {
+    FILE* f = fopen(IMPORT_FILE, "wb");
+    if (!f) return 0;
+    for (int i = 0; i < IMPORT_LINES; i++) fprintf(f, "bimp%06d\t释义%d-%d\n", i, i, variant);
+    fclose(f);
+    return 1;
+}
+
+static int run_import(const char* label, int variant, int expect_inserted, int expect_updated) {
+    struct ImportStats st;
+    if (!write_import_file(variant)) return 0;
+    long long start = timerNowNs();
+    int ok = importQuestionsBulk(IMPORT_FILE, &st);
+    report(label, IMPORT_LINES, timerNowNs() - start);
+    printf("  inserted=%d updated=%d skipped=%d\n", st.inserted, st.updated, st.skipped);
+    return ok && st.inserted == expect_inserted && st.updated == expect_updated
+           && st.inserted + st.updated + st.skipped == IMPORT_LINES;
+}
+
+/**
+ * @brief 批量导入 10 万行题目：全新导入、重复导入（全部跳过）、修改翻译后导入（全部更新）
+ */
+static int bench_import(void) {
+    sqlite3_exec(dbGet(), "DELETE FROM questions WHERE word LIKE 'bimp%'", NULL, NULL, NULL);
+    int ok = run_import("importQuestionsBulk (new)", 0, IMPORT_LINES, 0)
+          && run_import("importQuestionsBulk (unchanged)", 0, 0, 0)
+          && run_import("importQuestionsBulk (updated)", 1, 0, IMPORT_LINES);
+    sqlite3_exec(dbGet(), "DELETE FROM questions WHERE word LIKE 'bimp%'", NULL, NULL, NULL);
+    remove(IMPORT_FILE);
+    return ok ? 0 : 1;
+}
+
+static int count_word(const char* word, const char* translate, void* ctx) {
+    (void)word;
+    (void)translate;
+    (*(int*)ctx)++;
+    return 0;
+}
+
+/**
+ * @brief CET4 词库：ATTACH 导入（全部 / 按词性与长度筛选 / 重复导入）与直接查询模式
+ */
+static int bench_dict(void) {
+    const char* path = "bench_dict.db";
+    struct DictFilter nouns = {"n.", 4, 8, 1, 0};
+    struct ImportStats st;
+    int ok = 1;
+
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+    sqlite3_exec(dbGet(), "DELETE FROM questions", NULL, NULL, NULL);
+
+    long long start = timerNowNs();
+    ok = ok && importDictQuestions(DICT_NAME, &nouns, &st);
+    report("importDictQuestions (n., 4-8)", st.inserted + st.skipped, timerNowNs() - start);
+    printf("  inserted=%d skipped=%d\n", st.inserted, st.skipped);
+
+    start = timerNowNs();
+    ok = ok && importDictQuestions(DICT_NAME, NULL, &st);
+    report("importDictQuestions (all)", st.inserted + st.skipped, timerNowNs() - start);
+    printf("  inserted=%d skipped=%d\n", st.inserted, st.skipped);
+
+    start = timerNowNs();
+    ok = ok && importDictQuestions(DICT_NAME, NULL, &st) && st.inserted == 0;
+    report("importDictQuestions (again)", st.inserted + st.skipped, timerNowNs() - start);
+
+    /* 词库是 UTF-8，导入题库的释义应已转换为 GBK */
+    sqlite3_stmt* stmt = NULL;
+    int converted = 0;
+    if (sqlite3_prepare_v2(dbGet(), "SELECT translate FROM questions WHERE word = 'apple'", -1, &stmt, NULL) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        converted = strcmp((const char*)sqlite3_column_text(stmt, 0), "n.苹果") == 0;
+    }
+    sqlite3_finalize(stmt);
+
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(BENCH_DB) || !ok) return 1;
+
+    start = timerNowNs();
+    if (!dictOpen(DICT_NAME)) return 1;
+    int words = 0;
+    int rounds = iterations / 1000 > 0 ? iterations / 1000 : 1;
+    for (int i = 0; i < rounds; i++) dictForEach(NULL, count_word, &words);
+    report("dictForEach (all words)", words, timerNowNs() - start);
+
+    char trans[256];
+    start = timerNowNs();
+    for (int i = 0; i < rounds * 10; i++) ok = ok && dictLookup("access", trans, sizeof(trans));
+    report("dictLookup", rounds * 10, timerNowNs() - start);
+    converted = converted && dictLookup("apple", trans, sizeof(trans)) && strcmp(trans, "n.苹果") == 0;
+    printf("UTF-8 to GBK translations: %s\n", converted ? "ok" : "FAILED");
+    dictClose();
+    return ok && converted ? 0 : 1;
+}
+
+/* api 与 gen 用例的合成数据规格，学生每 30 人一个班级 */
+static struct SyntheticSpec api_spec(void) {
+    struct SyntheticSpec spec = {(seed_users + 29) / 30, 30, seed_questions, seed_answers, 20, 70, 20, 0, 42};
+    return spec;
+}
+
+static int api_classes(void) {
+    return (seed_users + 29) / 30;
+}
+
+/* 每个接口的单次调用，参数 i 为调用序号，成功返回 1 */
+static char api_uuid[37];
+
+static int api_createUser(int i) {
+    char name[32];
+    snprintf(name, sizeof(name), "api_new%d", i);
+    char* uuid = createUser(name, "0", 2, "api_new", 2 * SYN_FIRST_NUM + i, "");
+    free(uuid);
+    return uuid != NULL;
+}
+
+static int api_loginUser(int i) {
+    char name[32];
+    snprintf(name, sizeof(name), SYN_STUDENT_NAME, i % (api_classes() * 30));
+    char* uuid = loginUser(name, "0");
+    free(uuid);
+    return uuid != NULL;
+}
+
+static int api_loginUserProfile(int i) {
+    char name[32];
+    snprintf(name, sizeof(name), SYN_STUDENT_NAME, i % (api_classes() * 30));
+    struct UserProfile profile;
+    return loginUserProfile(name, "0", &profile) && profile.level == 2 && profile.class_name[0];
+}
+
+/* 旧的登录流程：loginUser 取得 UUID 后再用 getUserLevel 查一次等级 */
+static int api_loginUserAndLevel(int i) {
+    char name[32];
+    snprintf(name, sizeof(name), SYN_STUDENT_NAME, i % (api_classes() * 30));
+    char* uuid = loginUser(name, "0");
+    int ok = uuid && getUserLevel(uuid) == 2;
+    free(uuid);
+    return ok;
+}
+
+static int api_saveAnswerRecord(int i) {
+    return saveAnswerRecord(api_uuid, i % seed_questions + 1, "x", i % 2, i % 2 ? 10 : 0);
+}
+
+static int api_getQuestions(int i) {
+    (void)i;
+    int count = 0;
+    struct Question* q = getQuestions(&count);
+    free(q);
+    return count == seed_questions;
+}
+
+static int api_getQuestionsLL(int i) {
+    (void)i;
+    int count = 0;
+    freeQuestionList(getQuestionsLL(&count));
+    return count == seed_questions;
+}
+
+static int api_getGradesByName(int i) {
+    char name[32];
+    snprintf(name, sizeof(name), SYN_STUDENT_NAME, i % (api_classes() * 30));
+    int count = 0;
+    freeGrades(getGradesByName(name, &count));
+    return count > 0;
+}
+
+static int api_getGradesByClass(int i) {
+    char class_name[16];
+    snprintf(class_name, sizeof(class_name), SYN_CLASS_NAME, i % api_classes());
+    int count = 0;
+    freeGrades(getGradesByClass(class_name, &count));
+    return count > 0;
+}
+
+static int api_getGradesByStudentNumRange(int i) {
+    int min_num = SYN_FIRST_NUM + (i * 30) % (api_classes() * 30);
+    int count = 0;
+    freeGrades(getGradesByStudentNumRange(min_num, min_num + 29, &count));
+    return count > 0;
+}
+
+static int api_statisticsByClass(int i) {
+    char class_name[16];
+    snprintf(class_name, sizeof(class_name), SYN_CLASS_NAME, i % api_classes());
+    statisticsByClass(class_name);
+    return 1;
+}
+
+static int api_exportQuestionsToFile(int i) {
+    (void)i;
+    return exportQuestionsToFile("bench_timu_out.txt");
+}
+
+static int api_exportGradesToFile(int i) {
+    (void)i;
+    return exportGradesToFile("bench_stu_out.txt");
+}
+
+static int api_exportGradesByScoreToFile(int i) {
+    (void)i;
+    return exportGradesByScoreToFile("bench_sort1_out.txt");
+}
+
+static int api_exportGradesByClassToFile(int i) {
+    (void)i;
+    return exportGradesByClassToFile("bench_sort2_out.txt");
+}
+
+struct ApiCase {
+    const char* name;
+    int (*call)(int i);
+    int divisor;    /* 调用次数为 iterations / divisor */
+};
+
+static const struct ApiCase api_cases[] = {
+    {"createUser", api_createUser, 20},
+    {"loginUser", api_loginUser, 1},
+    {"loginUser + getUserLevel", api_loginUserAndLevel, 1},
+    {"loginUserProfile", api_loginUserProfile, 1},
+    {"saveAnswerRecord", api_saveAnswerRecord, 10},
+    {"getQuestions", api_getQuestions, 20},
+    {"getQuestionsLL", api_getQuestionsLL, 20},
+    {"getGradesByName", api_getGradesByName, 1},
+    {"getGradesByClass", api_getGradesByClass, 1},
+    {"getGradesByStudentNumRange", api_getGradesByStudentNumRange, 1},
+    {"statisticsByClass", api_statisticsByClass, 10},
+    {"exportQuestionsToFile", api_exportQuestionsToFile, 200},
+    {"exportGradesToFile", api_exportGradesToFile, 200},
+    {"exportGradesByScoreToFile", api_exportGradesByScoreToFile, 200},
+    {"exportGradesByClassToFile", api_exportGradesByClassToFile, 200},
+};
+
+/**
+ * @brief 在按给定规模准备的全新数据库上，逐个接口测量吞吐量与延迟分位数
+ */
+static int bench_api(void) {
+    dbClose();
+    remove_db_files(API_DB);
+    if (!dbOpen(API_DB)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    int ok = load_synthetic_data(&spec);
+    char name[32];
+    snprintf(name, sizeof(name), SYN_STUDENT_NAME, 0);
+    char* uuid = ok ? loginUser(name, "0") : NULL;
+    if (uuid) {
+        snprintf(api_uuid, sizeof(api_uuid), "%s", uuid);
+        free(uuid);
+    } else {
+        ok = 0;
+    }
+
+    for (size_t c = 0; ok && c < sizeof(api_cases) / sizeof(api_cases[0]); c++) {
+        int n = iterations / api_cases[c].divisor > 0 ? iterations / api_cases[c].divisor : 1;
+        struct Samples s = {(long long*)malloc(sizeof(long long) * n), 0, 0, 0};
+        if (!s.ns) {
+            ok = 0;
+            break;
+        }
+        mute_stdout();
+        for (int i = 0; i < n; i++) {
+            long long t = timerNowNs();
+            int call_ok = api_cases[c].call(i);
+            t = timerNowNs() - t;
+            s.ns[s.n++] = t;
+            s.total += t;
+            if (!call_ok) s.errors++;
+        }
+        unmute_stdout();
+        report_samples(api_cases[c].name, &s);
+        free(s.ns);
+    }
+
+    remove("bench_timu_out.txt");
+    remove("bench_stu_out.txt");
+    remove("bench_sort1_out.txt");
+    remove("bench_sort2_out.txt");
+    dbClose();
+    remove_db_files(API_DB);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/**
+ * @brief 在另一个连接上插入或删除一道题目，模拟其他进程修改题库
+ */
+static int external_question_change(int insert) {
+    sqlite3* db = dbPoolAcquire();
+    if (!db) return 0;
+    const char* sql = insert ? "INSERT INTO questions (word, translate) VALUES ('bench_external', 'x')"
+                             : "DELETE FROM questions WHERE word = 'bench_external'";
+    int ok = sqlite3_exec(db, sql, NULL, NULL, NULL) == SQLITE_OK;
+    dbPoolRelease(db);
+    return ok;
+}
+
+/**
+ * @brief 对比每次从数据库读取题库与使用题库缓存，比较两种题目表示的内存占用，
+ * 并检查增删题目后缓存能否及时失效（题库为合成题目加上 CET4 词库）
+ */
+static int bench_qcache(void) {
+    dbClose();
+    remove_db_files(API_DB);
+    if (!dbOpen(API_DB)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.classes = 0;
+    int ok = load_synthetic_data(&spec);
+    mute_stdout();
+    ok = ok && importDictQuestions(DICT_NAME, NULL, NULL);
+    unmute_stdout();
+    const struct QuestionSet* set = ok ? questionCacheGet() : NULL;
+    if (!set || set->count == 0) ok = 0;
+    int expected = set ? set->count : 0;
+    if (ok) {
+        double compact = (double)questionSetBytes(set) / expected;
+        printf("%d questions: struct Question %zu bytes each, QuestionSet %.1f bytes each (%.1fx smaller)\n",
+               expected, sizeof(struct Question), compact, sizeof(struct Question) / compact);
+        emit_metric("bytes per question (struct Question)", (double)sizeof(struct Question));
+        emit_metric("bytes per question (QuestionSet)", compact);
+    }
+    int n = iterations / 20 > 0 ? iterations / 20 : 1;
+    int count = 0;
+
+    long long start = timerNowNs();
+    for (int i = 0; ok && i < n; i++) {
+        questionCacheInvalidate();
+        freeQuestions(getQuestions(&count));
+    }
+    report("getQuestions (reload each)", n, timerNowNs() - start);
+
+    questionCacheResetStats();
+    start = timerNowNs();
+    for (int i = 0; ok && i < n; i++) freeQuestions(getQuestions(&count));
+    report("getQuestions (cached)", n, timerNowNs() - start);
+
+    start = timerNowNs();
+    for (int i = 0; ok && i < n; i++) freeQuestionList(getQuestionsLL(&count));
+    report("getQuestionsLL (cached)", n, timerNowNs() - start);
+
+    /* 直接遍历紧凑集合，不再展开为 struct Question */
+    size_t letters = 0;
+    start = timerNowNs();
+    for (int i = 0; ok && i < n; i++) {
+        set = questionCacheGet();
+        for (int q = 0; set && q < set->count; q++) letters += set->spans[q].word_len;
+    }
+    report("questionCacheGet + scan", n, timerNowNs() - start);
+    if (letters == 0) ok = 0;
+
+    struct QuestionCacheStats st;
+    questionCacheGetStats(&st);
+    printf("cache hits %lld, loads %lld\n", st.hits, st.loads);
+
+    /* 本连接与其他连接的修改都应在下一次取用时可见 */
+    mute_stdout();
+    int add_ok = addSingleQuestion("bench_cached", "x");
+    unmute_stdout();
+    ok = ok && add_ok;
+    freeQuestions(getQuestions(&count));
+    ok = ok && count == ++expected;
+    ok = ok && external_question_change(1);
+    freeQuestions(getQuestions(&count));
+    ok = ok && count == ++expected;
+    ok = ok && external_question_change(0);
+    freeQuestions(getQuestions(&count));
+    ok = ok && count == --expected;
+    printf("invalidation check: %s\n", ok ? "ok" : "FAILED");
+
+    dbClose();
+    remove_db_files(API_DB);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* list 用例的题目数 */
+#define LIST_QUESTIONS 100000
+
+/**
+ * @brief 旧的链表构建方式：每个节点单独 malloc 并清零
+ */
+static struct QuestionNode* list_with_malloc(const struct QuestionSet* set) {
+    struct QuestionNode* head = NULL;
+    struct QuestionNode* tail = NULL;
+    for (int i = 0; i < set->count; i++) {
+        struct QuestionNode* node = (struct QuestionNode*)malloc(sizeof(struct QuestionNode));
+        if (!node) break;
+        memset(node, 0, sizeof(*node));
+        questionSetToQuestion(set, i, &node->q);
+        if (!head) head = tail = node;
+        else { tail->next = node; tail = node; }
+    }
+    return head;
+}
+
+static void free_malloc_list(struct QuestionNode* head) {
+    while (head) {
+        struct QuestionNode* next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+/**
+ * @brief 沿 next 遍历链表，返回各单词首字母之和，防止遍历被优化掉
+ */
+static long long traverse_list(const struct QuestionNode* head) {
+    long long sum = 0;
+    for (const struct QuestionNode* p = head; p; p = p->next) sum += p->q.qid + (unsigned char)p->q.word[0];
+    return sum;
+}
+
+/**
+ * @brief 在 LIST_QUESTIONS 道题目上对比逐节点 malloc 的链表与连续 slab 链表的构建、遍历与释放耗时
+ */
+static int bench_list(void) {
+    const char* path = "bench_list.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.classes = 0;
+    spec.questions = LIST_QUESTIONS;
+    mute_stdout();
+    int ok = load_synthetic_data(&spec);
+    unmute_stdout();
+    const struct QuestionSet* set = ok ? questionCacheGet() : NULL;
+    if (!set || set->count != LIST_QUESTIONS) ok = 0;
+
+    int rounds = iterations / 4000 > 0 ? iterations / 4000 : 1;
+    long long build[2] = {0, 0}, walk[2] = {0, 0}, release[2] = {0, 0};
+    long long sums[2] = {0, 0};
+    for (int r = 0; ok && r < rounds; r++) {
+        long long t = timerNowNs();
+        struct QuestionNode* head = list_with_malloc(set);
+        build[0] += timerNowNs() - t;
+        t = timerNowNs();
+        sums[0] += traverse_list(head);
+        walk[0] += timerNowNs() - t;
+        t = timerNowNs();
+        free_malloc_list(head);
+        release[0] += timerNowNs() - t;
+
+        int count = 0;
+        t = timerNowNs();
+        head = getQuestionsLL(&count);
+        build[1] += timerNowNs() - t;
+        t = timerNowNs();
+        sums[1] += traverse_list(head);
+        walk[1] += timerNowNs() - t;
+        t = timerNowNs();
+        freeQuestionList(head);
+        release[1] += timerNowNs() - t;
+        if (count != LIST_QUESTIONS) ok = 0;
+    }
+    if (sums[0] != sums[1]) ok = 0;
+
+    int nodes = rounds * LIST_QUESTIONS;
+    report("build (malloc per node)", nodes, build[0]);
+    report("build (slab)", nodes, build[1]);
+    report("traverse (malloc per node)", nodes, walk[0]);
+    report("traverse (slab)", nodes, walk[1]);
+    report("free (malloc per node)", nodes, release[0]);
+    report("free (slab)", nodes, release[1]);
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/**
+ * @brief 抽样 rounds 次，每次 k 道题，检查题数与是否重复，返回总耗时（出错返回 -1）
+ */
+static long long time_sampling(int rounds, int k, enum QuizSampling sampling, int expected) {
+    struct QuestionSet set;
+    questionSetInit(&set);
+    long long ns = 0;
+    for (int r = 0; r < rounds; r++) {
+        questionSetTruncate(&set, 0);
+        long long t = timerNowNs();
+        int n = sampleQuestions(k, sampling, &set);
+        ns += timerNowNs() - t;
+        for (int i = 0; n == expected && i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                if (set.qids[i] == set.qids[j]) n = -1;
+            }
+        }
+        if (n != expected) {
+            ns = -1;
+            break;
+        }
+    }
+    questionSetFree(&set);
+    return ns;
+}
+
+/**
+ * @brief 在 LIST_QUESTIONS 道题目（删去三分之一形成 qid 空洞）上对比读取整个题库与随机抽取 k 道题
+ */
+static int bench_sample(void) {
+    const char* path = "bench_sample.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.classes = 0;
+    spec.questions = LIST_QUESTIONS;
+    mute_stdout();
+    int ok = load_synthetic_data(&spec);
+    unmute_stdout();
+    ok = ok && sqlite3_exec(dbGet(), "DELETE FROM questions WHERE qid % 3 = 0", NULL, NULL, NULL) == SQLITE_OK;
+    int remaining = LIST_QUESTIONS - LIST_QUESTIONS / 3;
+
+    int rounds = iterations / 100 > 0 ? iterations / 100 : 1;
+    int k = QUIZ_DEFAULT_SIZE;
+    long long start = timerNowNs();
+    for (int r = 0; ok && r < rounds / 10 + 1; r++) {
+        questionCacheClear();
+        int count = 0;
+        freeQuestions(getQuestions(&count));
+        if (count != remaining) ok = 0;
+    }
+    report("getQuestions (whole bank)", rounds / 10 + 1, timerNowNs() - start);
+
+    long long ns = ok ? time_sampling(rounds, k, QUIZ_SAMPLE_UNIFORM, k) : -1;
+    if (ns < 0) ok = 0;
+    else report("sampleQuestions k=20 (uniform)", rounds, ns);
+    ns = ok ? time_sampling(rounds / 10 + 1, k, QUIZ_SAMPLE_WEIGHTED, k) : -1;
+    if (ns < 0) ok = 0;
+    else report("sampleQuestions k=20 (weighted)", rounds / 10 + 1, ns);
+
+    /* qid 空洞过多时均匀抽样退回蓄水池抽样 */
+    ok = ok && sqlite3_exec(dbGet(), "DELETE FROM questions WHERE qid > 100 AND qid < 99990", NULL, NULL, NULL) == SQLITE_OK;
+    ns = ok ? time_sampling(rounds, k, QUIZ_SAMPLE_UNIFORM, k) : -1;
+    if (ns < 0) ok = 0;
+    else report("sampleQuestions k=20 (sparse qids)", rounds, ns);
+    /* 题库不足 k 道时返回全部题目 */
+    ns = ok ? time_sampling(1, 1000, QUIZ_SAMPLE_UNIFORM, 67 + 7) : -1;
+    if (ns < 0) ok = 0;
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* review 用例中一名学生练习过的单词数 */
+#define REVIEW_WORDS 50000
+
+/**
+ * @brief 读取学生某个单词的复习间隔（天），不存在返回 -1
+ */
+static int review_interval(const char* uuid, int qid) {
+    sqlite3_stmt* stmt = NULL;
+    int days = -1;
+    if (sqlite3_prepare_v2(dbGet(), "SELECT interval_days FROM review_state WHERE student_uuid = ? AND qid = ?",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        uuidBind(stmt, 1, uuid);
+        sqlite3_bind_int(stmt, 2, qid);
+        if (sqlite3_step(stmt) == SQLITE_ROW) days = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return days;
+}
+
+/**
+ * @brief 一名学生练习过 REVIEW_WORDS 个单词（单数 qid 答对）后，测量记录答案与取出到期单词的耗时，
+ * 并检查 SM-2 间隔的变化
+ */
+static int bench_review(void) {
+    const char* path = "bench_review.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.classes = 0;
+    spec.questions = REVIEW_WORDS;
+    mute_stdout();
+    int ok = load_synthetic_data(&spec);
+    unmute_stdout();
+    char* uuid = ok ? bench_user() : NULL;
+    if (!uuid) ok = 0;
+
+    long long start = timerNowNs();
+    beginAnswerSession();
+    for (int q = 1; ok && q <= REVIEW_WORDS; q++) saveAnswerRecord(uuid, q, "x", q % 2, q % 2 ? 10 : 0);
+    ok = endAnswerSession() && ok;
+    report("saveAnswerRecord (review trigger)", REVIEW_WORDS, timerNowNs() - start);
+
+    /* 答错的单词立即到期，答对的单词一天后到期 */
+    long long now = (long long)time(NULL);
+    const long long checks[] = {now, now + 2 * 86400LL};
+    const char* labels[] = {"reviewDueQuestions (due now)", "reviewDueQuestions (due in 2 days)"};
+    int rounds = iterations / 10 > 0 ? iterations / 10 : 1;
+    struct QuestionSet set;
+    questionSetInit(&set);
+    for (int c = 0; ok && c < 2; c++) {
+        start = timerNowNs();
+        for (int r = 0; ok && r < rounds; r++) {
+            questionSetTruncate(&set, 0);
+            if (reviewDueQuestions(uuid, checks[c], QUIZ_DEFAULT_SIZE, &set) != QUIZ_DEFAULT_SIZE) ok = 0;
+        }
+        report(labels[c], rounds, timerNowNs() - start);
+    }
+    if (ok && set.qids[0] % 2 == 0 && reviewDueQuestions(uuid, now, QUIZ_DEFAULT_SIZE, &set) >= 0) {
+        /* 到期时间相同的单词之间顺序不定，只检查第一批都是答错的单词 */
+        for (int i = QUIZ_DEFAULT_SIZE; i < set.count; i++) {
+            if (set.qids[i] % 2) ok = 0;
+        }
+    }
+    questionSetFree(&set);
+
+    /* qid 2 先前答错（ease 1.96），之后连续答对三次间隔为 1、6、round(6 * 2.16) = 13 天，再答错归零 */
+    const int expected[] = {1, 6, 13, 0};
+    for (int i = 0; ok && i < 4; i++) {
+        int correct = i < 3;
+        ok = saveAnswerRecord(uuid, 2, "x", correct, correct ? 10 : 0) && review_interval(uuid, 2) == expected[i];
+    }
+    printf("SM-2 interval check: %s\n", ok ? "ok" : "FAILED");
+
+    free(uuid);
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/**
+ * @brief 旧的组卷方式：每个难度用 ORDER BY random() 取题，需要扫描并排序整个难度
+ */
+static int mix_with_order_by_random(const int counts[DIFFICULTY_LEVELS]) {
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(dbGet(), "SELECT qid, word, translate FROM questions WHERE difficulty = ? "
+                           "ORDER BY random() LIMIT ?", -1, &stmt, NULL) != SQLITE_OK) return -1;
+    int n = 0;
+    for (int i = 0; i < DIFFICULTY_LEVELS; i++) {
+        sqlite3_bind_int(stmt, 1, i + 1);
+        sqlite3_bind_int(stmt, 2, counts[i]);
+        while (sqlite3_step(stmt) == SQLITE_ROW) n++;
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return n;
+}
+
+/**
+ * @brief 在 api 用例的数据上重新计算难度，对比按难度比例组卷的两种方式，并检查各难度的题数
+ */
+static int bench_difficulty(void) {
+    const char* path = "bench_difficulty.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.questions = seed_questions * 100;
+    int ok = load_synthetic_data(&spec);
+
+    mute_stdout();
+    long long start = timerNowNs();
+    int changed = ok ? recomputeDifficulty(1) : -1;
+    long long ns = timerNowNs() - start;
+    unmute_stdout();
+    if (changed < 0) ok = 0;
+    report("recomputeDifficulty (questions)", spec.questions, ns);
+
+    const int mix[DIFFICULTY_LEVELS] = {10, 20, 40, 20, 10};
+    const int counts[DIFFICULTY_LEVELS] = {2, 4, 8, 4, 2};
+    int rounds = iterations / 100 > 0 ? iterations / 100 : 1;
+    start = timerNowNs();
+    for (int r = 0; ok && r < rounds / 10 + 1; r++) {
+        if (mix_with_order_by_random(counts) != QUIZ_DEFAULT_SIZE) ok = 0;
+    }
+    report("paper k=20 (ORDER BY random())", rounds / 10 + 1, timerNowNs() - start);
+
+    struct QuestionSet set;
+    questionSetInit(&set);
+    start = timerNowNs();
+    for (int r = 0; ok && r < rounds; r++) {
+        questionSetTruncate(&set, 0);
+        if (sampleByDifficultyMix(mix, QUIZ_DEFAULT_SIZE, &set) != QUIZ_DEFAULT_SIZE) ok = 0;
+    }
+    report("paper k=20 (qid probes)", rounds, timerNowNs() - start);
+
+    /* 最后一份试卷中各难度的题数应与比例一致 */
+    int got[DIFFICULTY_LEVELS] = {0};
+    sqlite3_stmt* stmt = NULL;
+    if (ok && sqlite3_prepare_v2(dbGet(), "SELECT difficulty FROM questions WHERE qid = ?", -1, &stmt, NULL) == SQLITE_OK) {
+        for (int i = 0; i < set.count; i++) {
+            sqlite3_bind_int(stmt, 1, set.qids[i]);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                int d = sqlite3_column_int(stmt, 0);
+                if (d >= 1 && d <= DIFFICULTY_LEVELS) got[d - 1]++;
+            }
+            sqlite3_reset(stmt);
+        }
+    }
+    sqlite3_finalize(stmt);
+    for (int i = 0; i < DIFFICULTY_LEVELS; i++) {
+        if (got[i] != counts[i]) ok = 0;
+    }
+    printf("%d questions changed difficulty; paper mix %d/%d/%d/%d/%d: %s\n",
+           changed, got[0], got[1], got[2], got[3], got[4], ok ? "ok" : "FAILED");
+    questionSetFree(&set);
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* names 用例的学生数为 --users 的倍数 */
+#define NAMES_USER_FACTOR 30
+
+static int count_row(const struct GradeRow* row, void* ctx) {
+    (void)row;
+    (*(int*)ctx)++;
+    return 0;
+}
+
+/* 分页读取成绩时收集每行的 UUID */
+struct PagedUuids {
+    char (*uuids)[UUID_STR_LEN];
+    int count;
+    int capacity;
+};
+
+static int collect_uuid(const struct GradeRow* row, void* ctx) {
+    struct PagedUuids* p = (struct PagedUuids*)ctx;
+    if (p->count >= p->capacity) return -1;
+    snprintf(p->uuids[p->count++], UUID_STR_LEN, "%s", row->uuid);
+    return 0;
+}
+
+/**
+ * @brief 按 page 行一页读完一个班级的成绩（与菜单相同，每页一次新的查询），检查每名学生恰好出现一次
+ */
+static int class_pages_ok(const char* class_name, int students, int page) {
+    struct PagedUuids p = {(char (*)[UUID_STR_LEN])malloc(UUID_STR_LEN * (size_t)(students + page)), 0, students + page};
+    if (!p.uuids) return 0;
+    int rows;
+    do {
+        rows = forEachGradeByClass(class_name, page, p.count, collect_uuid, &p);
+    } while (rows == page);
+    int ok = rows >= 0 && p.count == students;
+    for (int i = 0; ok && i < p.count; i++) {
+        for (int j = 0; ok && j < i; j++) ok = strcmp(p.uuids[i], p.uuids[j]) != 0;
+    }
+    free(p.uuids);
+    return ok;
+}
+
+/**
+ * @brief 不用 n-gram 的按姓名包含查询：逐个用户按字节查找关键字（name 不含大写字母），返回匹配的行数
+ */
+static int names_by_scan(const char* name) {
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(dbGet(), stmtSql(STMT_GRADES_BY_NAME), -1, &stmt, NULL) != SQLITE_OK) return -1;
+    sqlite3_bind_blob(stmt, 1, name, (int)strlen(name), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, -1);
+    sqlite3_bind_int(stmt, 3, 0);
+    int n = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) n++;
+    sqlite3_finalize(stmt);
+    return n;
+}
+
+/**
+ * @brief 对比按姓名包含查询的扫描与 username_grams，测量开头与完全相同匹配，并检查增删用户后的同步，
+ * 以及 GBK 姓名中从第二个汉字开始的关键字与含 _ 的关键字
+ */
+static int bench_names(void) {
+    const char* path = "bench_names.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.classes *= NAMES_USER_FACTOR;
+    spec.answers_per_student = 2;
+    mute_stdout();
+    int ok = load_synthetic_data(&spec);
+    unmute_stdout();
+    int users = spec.classes * spec.students_per_class;
+
+    static const struct {
+        enum NameMatch match;
+        const char* name;
+    } modes[] = {
+        {NAME_MATCH_SUBSTRING, "byName substring (grams)"},
+        {NAME_MATCH_PREFIX, "byName prefix"},
+        {NAME_MATCH_EXACT, "byName exact"},
+    };
+    int n = iterations / 20 > 0 ? iterations / 20 : 1;
+    char name[64];
+    for (size_t m = 0; ok && m < sizeof(modes) / sizeof(modes[0]); m++) {
+        struct Samples s = {(long long*)malloc(sizeof(long long) * n), 0, 0, 0};
+        if (!s.ns) return 1;
+        for (int i = 0; i < n; i++) {
+            /* 包含查询取学号的中间几位，开头查询取去掉最后两位的姓名 */
+            int index = (int)(uuidRandom64() % users);
+            snprintf(name, sizeof(name), SYN_STUDENT_NAME, index);
+            if (modes[m].match == NAME_MATCH_SUBSTRING && strlen(name) > 9) memmove(name, name + 8, strlen(name + 8) + 1);
+            if (modes[m].match == NAME_MATCH_PREFIX && strlen(name) > 9) name[strlen(name) - 2] = '\0';
+            int rows = 0;
+            long long t = timerNowNs();
+            if (forEachGradeByNameMatch(name, modes[m].match, 0, 0, count_row, &rows) <= 0) s.errors++;
+            t = timerNowNs() - t;
+            s.ns[s.n++] = t;
+            s.total += t;
+        }
+        report_samples(modes[m].name, &s);
+        if (s.errors) ok = 0;
+        free(s.ns);
+    }
+
+    /* 包含查询的结果与扫描一致 */
+    int rounds = n / 10 > 0 ? n / 10 : 1;
+    long long scan_ns = 0;
+    int matched = ok;
+    for (int i = 0; matched && i < rounds; i++) {
+        snprintf(name, sizeof(name), SYN_STUDENT_NAME, (int)(uuidRandom64() % users));
+        const char* query = strlen(name) > 9 ? name + 8 : name;
+        int rows = 0;
+        forEachGradeByNameMatch(query, NAME_MATCH_SUBSTRING, 0, 0, count_row, &rows);
+        long long t = timerNowNs();
+        int expect = names_by_scan(query);
+        scan_ns += timerNowNs() - t;
+        if (rows != expect) {
+            printf("  \"%s\": %d rows, scan %d\n", query, rows, expect);
+            matched = 0;
+        }
+    }
+    report("byName substring (scan)", rounds, scan_ns);
+
+    /*
+     * “的”的尾字节按 UTF-8 解码时与“东”连在一起，从“东”开始的关键字也应找到“好的东西”；
+     * _ 按字面匹配：n_stu 只匹配全部合成学生，不匹配 nxstu
+     */
+    char* gbk_uuid = matched ? createUser("好的东西", "0", 2, "probe", 2, NULL) : NULL;
+    char* like_uuid = matched ? createUser("nxstu", "0", 2, "probe", 3, NULL) : NULL;
+    int gbk_rows = 0, underscore_rows = 0;
+    forEachGradeByNameMatch("东西", NAME_MATCH_SUBSTRING, 0, 0, count_row, &gbk_rows);
+    forEachGradeByNameMatch("n_stu", NAME_MATCH_SUBSTRING, 0, 0, count_row, &underscore_rows);
+    if (gbk_rows != 1 || names_by_scan("东西") != 1 || underscore_rows != users || names_by_scan("n_stu") != users) {
+        printf("  \"东西\": %d rows; \"n_stu\": %d rows, expected %d\n", gbk_rows, underscore_rows, users);
+        matched = 0;
+    }
+    if (!gbk_uuid || !like_uuid || !deleteUser(gbk_uuid) || !deleteUser(like_uuid)) matched = 0;
+    free(gbk_uuid);
+    free(like_uuid);
+    if (!matched) ok = 0;
+
+    /* 新增与删除用户后 n-gram 立即同步 */
+    int synced = 0;
+    char* uuid = ok ? createUser("Zz名字探针", "0", 2, "probe", 1, NULL) : NULL;
+    if (uuid) {
+        int rows = 0;
+        forEachGradeByNameMatch("名字", NAME_MATCH_SUBSTRING, 0, 0, count_row, &rows);
+        synced = rows == 1;
+        rows = 0;
+        forEachGradeByNameMatch("zz", NAME_MATCH_SUBSTRING, 0, 0, count_row, &rows);
+        synced = synced && rows == 1;
+        synced = synced && deleteUser(uuid);
+        rows = 0;
+        forEachGradeByNameMatch("名字", NAME_MATCH_SUBSTRING, 0, 0, count_row, &rows);
+        synced = synced && rows == 0;
+        free(uuid);
+    }
+    if (!synced) ok = 0;
+
+    /* 每人只有两条答题记录，班级内大量同分，分页不应重复或遗漏 */
+    char class_name[32];
+    snprintf(class_name, sizeof(class_name), SYN_CLASS_NAME, 0);
+    int paged = class_pages_ok(class_name, spec.students_per_class, 7);
+    if (!paged) ok = 0;
+    printf("%d users; substring results match scan: %s; add/delete sync: %s; class paging: %s\n",
+           users, matched ? "ok" : "FAILED", synced ? "ok" : "FAILED", paged ? "ok" : "FAILED");
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* roster 用例的名单人数（一届新生） */
+#define ROSTER_SIZE 2000
+
+/**
+ * @brief 写出 roster 用例的名单：ROSTER_SIZE 名新学生，外加与库中重名、名单内重名与格式错误的各一行
+ */
+static int write_roster(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+    fprintf(f, "\xEF\xBB\xBFusername,password,level,class,student_num\r\n");
+    for (int i = 0; i < ROSTER_SIZE; i++) {
+        fprintf(f, "roster_bulk%d,pw%d,2,\"roster,%d\",%d\r\n", i, i, i % 40, 30000000 + i);
+    }
+    fprintf(f, "roster_loop0,0,2,dup,1\r\n");
+    fprintf(f, "roster_bulk0,0,2,dup,1\r\n");
+    fprintf(f, "roster_bad,0,student,x,1\r\n");
+    fprintf(f, "roster_admin,0,0,x,1\r\n");
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief 对比逐个 createUser 与 createUsersBulk 建立一届学生，并检查每行的状态与新用户的登录资料
+ */
+static int bench_roster(void) {
+    const char* path = "bench_roster.db";
+    const char* csv = "bench_roster.csv";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path) || !write_roster(csv)) return 1;
+
+    char name[32];
+    int ok = 1;
+    mute_stdout();
+    long long start = timerNowNs();
+    for (int i = 0; i < ROSTER_SIZE; i++) {
+        snprintf(name, sizeof(name), "roster_loop%d", i);
+        char* uuid = createUser(name, "0", 2, "loop", i, NULL);
+        if (!uuid) ok = 0;
+        free(uuid);
+    }
+    long long loop_ns = timerNowNs() - start;
+    unmute_stdout();
+    report("createUser loop", ROSTER_SIZE, loop_ns);
+
+    struct Roster roster;
+    start = timerNowNs();
+    int created = -1;
+    if (rosterLoad(csv, &roster)) created = createUsersBulk(roster.entries, roster.count);
+    long long bulk_ns = timerNowNs() - start;
+    report("rosterLoad + createUsersBulk", ROSTER_SIZE, bulk_ns);
+
+    int statuses = created == ROSTER_SIZE && roster.count == ROSTER_SIZE + 4 &&
+                   roster.entries[ROSTER_SIZE].status == ROSTER_DUPLICATE &&
+                   roster.entries[ROSTER_SIZE + 1].status == ROSTER_DUPLICATE &&
+                   roster.entries[ROSTER_SIZE + 2].status == ROSTER_INVALID &&
+                   roster.entries[ROSTER_SIZE + 3].status == ROSTER_INVALID;
+    for (int i = 0; statuses && i < ROSTER_SIZE; i++) {
+        statuses = roster.entries[i].status == ROSTER_OK && roster.entries[i].uuid[0];
+    }
+    struct UserProfile profile;
+    int profile_ok = loginUserProfile("roster_bulk7", "pw7", &profile) && profile.level == 2 &&
+                     strcmp(profile.class_name, "roster,7") == 0 && profile.student_num == 30000007 &&
+                     created > 7 && strcmp(profile.uuid, roster.entries[7].uuid) == 0;
+    rosterFree(&roster);
+    if (!statuses || !profile_ok) ok = 0;
+    printf("speedup %.1fx; row statuses: %s; login profile: %s\n", (double)loop_ns / (bulk_ns > 0 ? bulk_ns : 1),
+           statuses ? "ok" : "FAILED", profile_ok ? "ok" : "FAILED");
+
+    remove(csv);
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* purge 用例中每名学生的答题记录数（使删除释放足够多的页） */
+#define PURGE_ANSWERS 200
+
+/**
+ * @brief 执行返回单个整数的查询，失败返回 -1
+ */
+static long long query_int(const char* sql) {
+    sqlite3_stmt* stmt = NULL;
+    long long v = -1;
+    if (sqlite3_prepare_v2(dbGet(), sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        v = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return v;
+}
+
+/**
+ * @brief 学生已不存在的答题记录、成绩汇总、复习状态与 username_grams 行数
+ */
+static long long count_orphans(void) {
+    return query_int("SELECT COUNT(*) FROM answer_records WHERE student_uuid NOT IN (SELECT uuid FROM users)") +
+           query_int("SELECT COUNT(*) FROM review_state WHERE student_uuid NOT IN (SELECT uuid FROM users)") +
+           query_int("SELECT COUNT(*) FROM student_stats WHERE student_uuid NOT IN (SELECT uuid FROM users)") +
+           query_int("SELECT COUNT(*) FROM username_grams WHERE uuid NOT IN (SELECT uuid FROM users)");
+}
+
+/**
+ * @brief 模拟启动两次：测试用户 stu0 答题后再次写入测试数据，其 UUID 不变且不留下孤立记录
+ */
+static int restart_keeps_users(void) {
+    mute_stdout();
+    load_test_user_data();
+    char* before = loginUser("stu0", "0");
+    if (before) saveAnswerRecord(before, 1, "x", 1, 10);
+    load_test_user_data();
+    char* after = loginUser("stu0", "0");
+    unmute_stdout();
+    int ok = before && after && strcmp(before, after) == 0 && count_orphans() == 0;
+    free(before);
+    free(after);
+    return ok;
+}
+
+/**
+ * @brief 对比逐个 deleteUser 与按班级、学号范围批量删除学生，检查没有留下孤立的答题数据，
+ * 并对比分步的 incremental_vacuum 与完整 VACUUM 的耗时
+ */
+static int bench_purge(void) {
+    const char* path = "bench_purge.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    if (spec.classes < 4) spec.classes = 4;
+    spec.answers_per_student = PURGE_ANSWERS;
+    mute_stdout();
+    int ok = load_synthetic_data(&spec);
+    unmute_stdout();
+    int per_class = spec.students_per_class;
+    int restart_ok = restart_keeps_users();
+
+    /* 班级 syn0：逐个 deleteUser（不归还空闲页） */
+    char uuids[64][37];
+    int n = 0;
+    sqlite3_stmt* stmt = NULL;
+    char class_name[32];
+    snprintf(class_name, sizeof(class_name), SYN_CLASS_NAME, 0);
+    if (sqlite3_prepare_v2(dbGet(), "SELECT uuid FROM users WHERE class_name = ? AND user_level = 2",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, class_name, -1, SQLITE_STATIC);
+        while (n < 64 && sqlite3_step(stmt) == SQLITE_ROW) uuidColumn(stmt, 0, uuids[n++]);
+    }
+    sqlite3_finalize(stmt);
+    mute_stdout();
+    long long start = timerNowNs();
+    for (int i = 0; i < n; i++) {
+        if (!deleteUser(uuids[i])) ok = 0;
+    }
+    long long loop_ns = timerNowNs() - start;
+    unmute_stdout();
+    report("deleteUser (cascade)", n > 0 ? n : 1, loop_ns);
+
+    long long free_pages = query_int("PRAGMA freelist_count");
+    start = timerNowNs();
+    int reclaimed = dbReclaimSpace();
+    long long reclaim_ns = timerNowNs() - start;
+    printf("%-32s %8d pages %10.2f ms\n", "dbReclaimSpace", reclaimed, reclaim_ns / 1e6);
+
+    /* 班级 syn1 与 syn2、syn3 的学号范围：一条语句删除，随后自动归还空闲页 */
+    snprintf(class_name, sizeof(class_name), SYN_CLASS_NAME, 1);
+    start = timerNowNs();
+    int by_class = deleteUsersByClass(class_name);
+    report("deleteUsersByClass", by_class > 0 ? by_class : 1, timerNowNs() - start);
+    start = timerNowNs();
+    int by_range = deleteUsersByStudentNumRange(SYN_FIRST_NUM + 2 * per_class, SYN_FIRST_NUM + 4 * per_class - 1);
+    report("deleteUsersByStudentNumRange", by_range > 0 ? by_range : 1, timerNowNs() - start);
+    if (by_class != per_class || by_range != 2 * per_class || n != per_class) ok = 0;
+
+    long long orphans = count_orphans();
+    long long left_free = query_int("PRAGMA freelist_count");
+    long long mode = query_int("PRAGMA auto_vacuum");
+
+    /* 对照：完整 VACUUM 重写整个文件，期间持有写锁 */
+    start = timerNowNs();
+    int vacuumed = sqlite3_exec(dbGet(), "VACUUM", NULL, NULL, NULL) == SQLITE_OK;
+    long long vacuum_ns = timerNowNs() - start;
+    printf("%-32s %8lld pages %10.2f ms\n", "VACUUM (whole file)", query_int("PRAGMA page_count"), vacuum_ns / 1e6);
+
+    if (orphans != 0 || left_free != 0 || mode != 2 || reclaimed != free_pages || !vacuumed || !restart_ok) ok = 0;
+    printf("%d students deleted; orphan rows: %lld; auto_vacuum=%lld; free pages left: %lld; restart: %s\n",
+           n + by_class + by_range, orphans, mode, left_free, restart_ok ? "ok" : "FAILED");
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* search 用例每次搜索最多取回的结果数（与菜单中显示的条数相当） */
+#define SEARCH_LIMIT 20
+
+/* 与搜索结果核对的 LIKE 查询次数（每次扫描整张表） */
+#define SEARCH_CHECKS 20
+
+/**
+ * @brief 用 LIKE 扫描题库统计匹配数，作为搜索结果的对照
+ */
+static int count_like(const char* sql, const char* query) {
+    sqlite3_stmt* stmt = NULL;
+    int n = -1;
+    if (sqlite3_prepare_v2(dbGet(), sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, query, -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) n = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return n;
+}
+
+/**
+ * @brief 按第 i 个关键字的取法从题库中取一个关键字：单词开头、单词中间 3 个字母或去掉词性的翻译，
+ * 翻译每隔一次再去掉第一个汉字（GBK 两字节），使关键字从文本中间的字符边界开始
+ */
+static void search_query(const struct QuestionSet* set, enum SearchMode mode, char* out, int size) {
+    static int translations = 0;
+    int i = (int)(uuidRandom64() % set->count);
+    const char* word = questionSetWord(set, i);
+    int len = (int)strlen(word);
+    if (mode == SEARCH_PREFIX) {
+        snprintf(out, size, "%.*s", len < 3 ? len : 3, word);
+    } else if (mode == SEARCH_SUBSTRING) {
+        int from = len > 3 ? (int)(uuidRandom64() % (len - 2)) : 0;
+        snprintf(out, size, "%.3s", word + from);
+    } else {
+        const char* t = questionSetTranslate(set, i);
+        if (strncmp(t, "n.", 2) == 0) t += 2;
+        if (translations++ % 2 && (unsigned char)t[0] >= 0x81 && t[1]) t += 2;
+        snprintf(out, size, "%s", t);
+    }
+}
+
+/**
+ * @brief 用 SEARCH_CHECKS 个随机关键字核对不限条数时的结果数与 LIKE 扫描一致
+ */
+static int search_matches_like(const struct QuestionSet* set, enum SearchMode mode, const char* like,
+                               struct QuestionSet* found) {
+    char query[128];
+    int ok = 1;
+    for (int i = 0; i < SEARCH_CHECKS; i++) {
+        search_query(set, mode, query, sizeof(query));
+        questionSetTruncate(found, 0);
+        int got = searchWords(SEARCH_QUESTIONS, mode, query, 0, found);
+        int expect = count_like(like, query);
+        if (got != expect) {
+            printf("  \"%s\": %d results, LIKE %d\n", query, got, expect);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief 在 10 万道题目上测量建立索引与三种搜索的延迟，与 LIKE 扫描核对结果数，
+ * 检查增删题目后索引同步，并在 CET4 词库上检查按翻译反查
+ */
+static int bench_search(void) {
+    const char* path = "bench_search.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    spec.classes = 0;
+    spec.questions = LIST_QUESTIONS;
+    mute_stdout();
+    int ok = load_synthetic_data(&spec);
+    unmute_stdout();
+    const struct QuestionSet* set = ok ? questionCacheGet() : NULL;
+    if (!set || set->count != LIST_QUESTIONS) ok = 0;
+
+    long long start = timerNowNs();
+    if (ok && !searchBuild(SEARCH_QUESTIONS)) ok = 0;
+    report("searchBuild (questions)", 1, timerNowNs() - start);
+
+    static const struct {
+        enum SearchMode mode;
+        const char* name;
+        const char* like;
+    } modes[] = {
+        {SEARCH_PREFIX, "searchWords (prefix)", "SELECT COUNT(*) FROM questions WHERE word LIKE ? || '%'"},
+        {SEARCH_SUBSTRING, "searchWords (substring)", "SELECT COUNT(*) FROM questions WHERE word LIKE '%' || ? || '%'"},
+        /* LIKE 按 UTF-8 解码 GBK 文本，会把前一个汉字的尾字节与后一个汉字连在一起，翻译改为按字节查找 */
+        {SEARCH_TRANSLATION, "searchWords (translation)",
+         "SELECT COUNT(*) FROM questions WHERE instr(CAST(lower(translate) AS BLOB), CAST(lower(?) AS BLOB)) > 0"},
+    };
+    struct QuestionSet found;
+    questionSetInit(&found);
+    char query[128];
+    int n = iterations / 10 > 0 ? iterations / 10 : 1;
+    for (size_t m = 0; ok && m < sizeof(modes) / sizeof(modes[0]); m++) {
+        struct Samples s = {(long long*)malloc(sizeof(long long) * n), 0, 0, 0};
+        if (!s.ns) return 1;
+        for (int i = 0; i < n; i++) {
+            search_query(set, modes[m].mode, query, sizeof(query));
+            questionSetTruncate(&found, 0);
+            long long t = timerNowNs();
+            if (searchWords(SEARCH_QUESTIONS, modes[m].mode, query, SEARCH_LIMIT, &found) <= 0) s.errors++;
+            t = timerNowNs() - t;
+            s.ns[s.n++] = t;
+            s.total += t;
+        }
+        report_samples(modes[m].name, &s);
+        if (s.errors) ok = 0;
+        free(s.ns);
+
+        /* 不限条数时结果数应与 LIKE 扫描一致 */
+        long long like_ns = 0;
+        for (int i = 0; ok && i < SEARCH_CHECKS; i++) {
+            search_query(set, modes[m].mode, query, sizeof(query));
+            questionSetTruncate(&found, 0);
+            int got = searchWords(SEARCH_QUESTIONS, modes[m].mode, query, 0, &found);
+            long long t = timerNowNs();
+            int expect = count_like(modes[m].like, query);
+            like_ns += timerNowNs() - t;
+            if (got != expect) {
+                printf("  \"%s\": %d results, LIKE %d\n", query, got, expect);
+                ok = 0;
+            }
+        }
+        printf("  LIKE scan %.2f us/query\n", like_ns / 1e3 / SEARCH_CHECKS);
+    }
+
+    /*
+     * 本进程增删题目后只更新该条目，下一次搜索应看到变化，其他条目的结果仍与 LIKE 一致。
+     * 探针的翻译按 UTF-8 解码时“的”的尾字节与“东”连在一起，从“东”开始的关键字也应找到它
+     */
+    int synced = 0;
+    start = timerNowNs();
+    if (ok && addSingleQuestion("Zzsearchprobe", "好的东西")) {
+        questionSetTruncate(&found, 0);
+        synced = searchWords(SEARCH_QUESTIONS, SEARCH_TRANSLATION, "东西", 0, &found) == 1;
+        report("add + searchWords", 1, timerNowNs() - start);
+        questionSetTruncate(&found, 0);
+        synced = synced && searchWords(SEARCH_QUESTIONS, SEARCH_PREFIX, "zzsearch", 0, &found) == 1;
+        synced = synced && search_matches_like(set, modes[1].mode, modes[1].like, &found)
+                 && search_matches_like(set, modes[2].mode, modes[2].like, &found);
+        questionSetTruncate(&found, 0);
+        searchWords(SEARCH_QUESTIONS, SEARCH_PREFIX, "zzsearch", 0, &found);
+        int qid = found.count == 1 ? found.qids[0] : 0;
+        /* 删除一个排在探针之前的题目，探针与之后条目的条目号都要前移 */
+        int earlier = set->qids[set->count / 2];
+        start = timerNowNs();
+        synced = synced && deleteSingleQuestion(earlier);
+        questionSetTruncate(&found, 0);
+        synced = synced && searchWords(SEARCH_QUESTIONS, SEARCH_PREFIX, "zzsearch", 0, &found) == 1;
+        report("delete + searchWords", 1, timerNowNs() - start);
+        synced = synced && deleteSingleQuestion(qid);
+        questionSetTruncate(&found, 0);
+        synced = synced && searchWords(SEARCH_QUESTIONS, SEARCH_PREFIX, "zzsearch", 0, &found) == 0;
+        synced = synced && search_matches_like(set, modes[0].mode, modes[0].like, &found)
+                 && search_matches_like(set, modes[2].mode, modes[2].like, &found);
+
+        /* 其他连接的修改只能通过 data_version 发现，索引整个重建 */
+        start = timerNowNs();
+        synced = synced && external_question_change(1);
+        questionSetTruncate(&found, 0);
+        synced = synced && searchWords(SEARCH_QUESTIONS, SEARCH_PREFIX, "bench_external", 0, &found) == 1;
+        report("external insert + searchWords (rebuild)", 1, timerNowNs() - start);
+        synced = synced && external_question_change(0);
+    }
+    if (!synced) ok = 0;
+
+    /* 词库：取一个单词的释义反查，结果中应包含该单词 */
+    int reverse = 0;
+    start = timerNowNs();
+    int built = searchBuild(SEARCH_DICT);
+    report("searchBuild (CET4)", 1, timerNowNs() - start);
+    questionSetTruncate(&found, 0);
+    if (built && searchWords(SEARCH_DICT, SEARCH_PREFIX, "apple", 1, &found) == 1) {
+        char word[64];
+        snprintf(word, sizeof(word), "%s", questionSetWord(&found, 0));
+        snprintf(query, sizeof(query), "%s", questionSetTranslate(&found, 0));
+        questionSetTruncate(&found, 0);
+        searchWords(SEARCH_DICT, SEARCH_TRANSLATION, query, 0, &found);
+        for (int i = 0; i < found.count; i++) {
+            if (strcmp(questionSetWord(&found, i), word) == 0) reverse = 1;
+        }
+    }
+    if (!reverse) ok = 0;
+    printf("results match LIKE; add/delete sync: %s; CET4 reverse lookup: %s\n",
+           synced ? "ok" : "FAILED", reverse ? "ok" : "FAILED");
+    questionSetFree(&found);
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/* grading 用例的答案对数，循环使用 */
+#define GRADE_PAIRS 4096
+
+/**
+ * @brief 对照用的逐字节动态规划编辑距离
+ */
+static int reference_distance(const char* a, int m, const char* b, int n) {
+    int row[256];
+    for (int i = 0; i <= m; i++) row[i] = i;
+    for (int j = 1; j <= n; j++) {
+        int diag = row[0];
+        row[0] = j;
+        for (int i = 1; i <= m; i++) {
+            int up = row[i];
+            int v = diag + (a[i - 1] != b[j - 1]);
+            if (up + 1 < v) v = up + 1;
+            if (row[i - 1] + 1 < v) v = row[i - 1] + 1;
+            diag = up;
+            row[i] = v;
+        }
+    }
+    return row[m];
+}
+
+/**
+ * @brief 生成 len 个小写字母，偶尔夹带大写字母与空格，模拟学生答案
+ */
+static void random_word(char* out, int len) {
+    for (int i = 0; i < len; i++) {
+        unsigned long long r = uuidRandom64();
+        out[i] = (char)('a' + r % 26);
+        if ((r >> 8) % 16 == 0) out[i] = (char)('A' + r % 26);
+        else if ((r >> 8) % 32 == 1) out[i] = ' ';
+    }
+    out[len] = '\0';
+}
+
+/**
+ * @brief 在 word 上随机做 edits 次插入、删除或替换，写入 out
+ */
+static void mutate_word(const char* word, char* out, int edits) {
+    strcpy(out, word);
+    for (int e = 0; e < edits; e++) {
+        int len = (int)strlen(out);
+        unsigned long long r = uuidRandom64();
+        int pos = len > 0 ? (int)(r % len) : 0;
+        char c = (char)('a' + (r >> 16) % 26);
+        switch ((r >> 32) % 3) {
+        case 0: memmove(out + pos + 1, out + pos, len - pos + 1); out[pos] = c; break;
+        case 1: if (len > 0) memmove(out + pos, out + pos + 1, len - pos); break;
+        default: if (len > 0) out[pos] = c; break;
+        }
+    }
+}
+
+/**
+ * @brief 测量编辑距离与评分的吞吐量，与动态规划对照检查距离，并检查各类答案的评分
+ */
+static int bench_grading(void) {
+    static char words[GRADE_PAIRS][72], answers[GRADE_PAIRS][80];
+    static int lens[GRADE_PAIRS], answer_lens[GRADE_PAIRS];
+    for (int i = 0; i < GRADE_PAIRS; i++) {
+        /* 大多是普通单词长度，少数超过 16 个字符；答案有一半完全正确，其余差 1 到 3 处 */
+        int len = 3 + (int)(uuidRandom64() % (i % 16 == 0 ? 60 : 12));
+        random_word(words[i], len);
+        mutate_word(words[i], answers[i], i % 2 ? 1 + (int)(uuidRandom64() % 3) : 0);
+        lens[i] = (int)strlen(words[i]);
+        answer_lens[i] = (int)strlen(answers[i]);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < GRADE_PAIRS; i++) {
+        int expect = reference_distance(answers[i], answer_lens[i], words[i], lens[i]);
+        if (editDistance(answers[i], answer_lens[i], words[i], lens[i], -1) != expect) ok = 0;
+        int capped = expect > 1 ? 2 : expect;
+        if (editDistance(answers[i], answer_lens[i], words[i], lens[i], 1) != capped) ok = 0;
+    }
+
+    int rounds = iterations * 50;
+    long long sum = 0;
+    long long start = timerNowNs();
+    for (int r = 0; r < rounds; r++) {
+        int i = r % GRADE_PAIRS;
+        sum += reference_distance(answers[i], answer_lens[i], words[i], lens[i]);
+    }
+    report("edit distance (dynamic programming)", rounds, timerNowNs() - start);
+
+    start = timerNowNs();
+    for (int r = 0; r < rounds; r++) {
+        int i = r % GRADE_PAIRS;
+        sum -= editDistance(answers[i], answer_lens[i], words[i], lens[i], -1);
+    }
+    report("editDistance (bit-parallel)", rounds, timerNowNs() - start);
+    if (sum != 0) ok = 0;
+
+    struct GradePolicy policy;
+    gradeDefaultPolicy(&policy);
+    int credit = 0;
+    start = timerNowNs();
+    for (int r = 0; r < rounds; r++) {
+        int i = r % GRADE_PAIRS;
+        credit += gradeAnswer(answers[i], words[i], &policy).credit;
+    }
+    long long ns = timerNowNs() - start;
+    report("gradeAnswer (default policy)", rounds, ns);
+    emit_metric("gradeAnswer comparisons/s", rounds * 1e9 / (ns > 0 ? ns : 1));
+
+    /* 各类答案的评分 */
+    static const struct {
+        const char* answer;
+        const char* expected;
+        enum GradeVerdict verdict;
+        int credit;
+    } checks[] = {
+        {"apple", "apple", GRADE_EXACT, 100},
+        {" Apple\t", "apple", GRADE_NORMALIZED, 100},
+        {"ice  cream", "ice cream", GRADE_NORMALIZED, 100},
+        {"aple", "apple", GRADE_TYPO, 50},
+        {"appel", "apple", GRADE_WRONG, 0},
+        {"car", "cat", GRADE_WRONG, 0},
+        {"", "apple", GRADE_WRONG, 0},
+        {"caf\xc3\xa9s", "cafes", GRADE_TYPO, 50},
+    };
+    int verdicts_ok = 1;
+    for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        struct GradeResult g = gradeAnswer(checks[i].answer, checks[i].expected, &policy);
+        if (g.verdict != checks[i].verdict || g.credit != checks[i].credit) {
+            printf("  \"%s\" vs \"%s\": verdict %d credit %d\n", checks[i].answer, checks[i].expected, g.verdict, g.credit);
+            verdicts_ok = 0;
+        }
+    }
+    printf("distance matches dynamic programming: %s; verdicts: %s; mean credit %.1f\n",
+           ok ? "ok" : "FAILED", verdicts_ok ? "ok" : "FAILED", (double)credit / rounds);
+    return ok && verdicts_ok ? 0 : 1;
+}
+
+/**
+ * @brief 在全新的数据库上按 --users / --questions / --answers 生成合成数据，测量写入速度
+ */
+static int bench_gen(void) {
+    const char* path = "bench_gen.db";
+    dbClose();
+    remove_db_files(path);
+    if (!dbOpen(path)) return 1;
+
+    struct SyntheticSpec spec = api_spec();
+    long long start = timerNowNs();
+    int ok = load_synthetic_data(&spec);
+    long long ns = timerNowNs() - start;
+
+    sqlite3_stmt* stmt = NULL;
+    int answers = 0;
+    if (sqlite3_prepare_v2(dbGet(), "SELECT COUNT(*) FROM answer_records", -1, &stmt, NULL) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        answers = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    report("load_synthetic_data (answers)", answers > 0 ? answers : 1, ns);
+
+    /* 生成时删除了复习触发器，每个答过的 (学生, 单词) 都应有一行 review_state */
+    int missing = -1;
+    if (sqlite3_prepare_v2(dbGet(), "SELECT COUNT(*) FROM (SELECT DISTINCT student_uuid, qid FROM answer_records) "
+                           "WHERE (student_uuid, qid) NOT IN (SELECT student_uuid, qid FROM review_state)",
+                           -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        missing = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    printf("review_state: %s\n", missing == 0 ? "ok" : "MISSING");
+    if (missing != 0) ok = 0;
+
+    /* 向已导入 CET4 词库的数据库生成：2 万个合成单词不能与真实单词（如 "tide"、"code"）冲突 */
+    dbClose();
+    remove_db_files(path);
+    int merged = dbOpen(path);
+    mute_stdout();
+    merged = merged && importDictQuestions(DICT_NAME, NULL, NULL);
+    unmute_stdout();
+    struct SyntheticSpec small = {1, 30, 20000, 10, 20, 70, 20, 0, 42};
+    merged = merged && load_synthetic_data(&small);
+    printf("generate after CET4 import: %s\n", merged ? "ok" : "FAILED");
+    if (!merged) ok = 0;
+
+    dbClose();
+    remove_db_files(path);
+    return dbOpen(BENCH_DB) && ok ? 0 : 1;
+}
+
+/**
+ * @brief 向全新的数据库逐批插入 rows 行 BLOB 主键（与 users 表相同），返回新分配的页数（即页分裂次数）
+ * written 输出提交时写出的页数：随机主键每个事务都会弄脏分散在索引各处的页，按时间排序的主键只弄脏最右侧的页
+ */
+static int insert_uuid_keys(void (*gen)(char*), int rows, long long* ns, int* written) {
+    const char* path = "bench_uuid.db";
+    remove_db_files(path);
+    sqlite3* db = NULL;
+    if (sqlite3_open(path, &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        return -1;
+    }
+    sqlite3_exec(db, "CREATE TABLE u (uuid BLOB PRIMARY KEY, name TEXT)", NULL, NULL, NULL);
+
+    sqlite3_stmt* stmt = NULL;
+    int pages = -1;
+    if (sqlite3_prepare_v2(db, "INSERT INTO u VALUES (?, 'bench')", -1, &stmt, NULL) == SQLITE_OK) {
+        int before = 0;
+        sqlite3_stmt* count = NULL;
+        sqlite3_prepare_v2(db, "PRAGMA page_count", -1, &count, NULL);
+        if (sqlite3_step(count) == SQLITE_ROW) before = sqlite3_column_int(count, 0);
+        sqlite3_reset(count);
+
+        long long start = timerNowNs();
+        char uuid[UUID_STR_LEN];
+        /* 每 100 行一个事务，模拟持续注册的用户 */
+        for (int i = 0; i < rows; i++) {
+            if (i % 100 == 0) sqlite3_exec(db, "BEGIN", NULL, NULL, NULL);
+            gen(uuid);
+            uuidBind(stmt, 1, uuid);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+            if (i % 100 == 99 || i == rows - 1) sqlite3_exec(db, "COMMIT", NULL, NULL, NULL);
+        }
+        *ns = timerNowNs() - start;
+
+        if (sqlite3_step(count) == SQLITE_ROW) pages = sqlite3_column_int(count, 0) - before;
+        sqlite3_finalize(count);
+        int hiwater = 0;
+        sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_WRITE, written, &hiwater, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    remove_db_files(path);
+    return pages;
+}
+
+/**
+ * @brief 按 answer_records 的结构（含 idx_answer_student）写入 rows 行，返回占用的页数
+ * as_blob 为 1 时 student_uuid 存 16 字节 BLOB，否则存 36 字符的文本
+ */
+static int answer_table_pages(int as_blob, int rows) {
+    const char* path = "bench_uuid.db";
+    remove_db_files(path);
+    sqlite3* db = NULL;
+    if (sqlite3_open(path, &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        return -1;
+    }
+    sqlite3_exec(db, "CREATE TABLE a (aid INTEGER PRIMARY KEY, student_uuid ANY, qid INTEGER, user_answer TEXT, is_correct INTEGER, score INTEGER);"
+                     "CREATE INDEX a_student ON a(student_uuid, score, is_correct);", NULL, NULL, NULL);
+
+    sqlite3_stmt* stmt = NULL;
+    int pages = -1;
+    if (sqlite3_prepare_v2(db, "INSERT INTO a (student_uuid, qid, user_answer, is_correct, score) VALUES (?, ?, 'answer', ?, ?)",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        char students[50][UUID_STR_LEN];
+        for (int i = 0; i < 50; i++) uuidV7(students[i]);
+        sqlite3_exec(db, "BEGIN", NULL, NULL, NULL);
+        for (int i = 0; i < rows; i++) {
+            if (as_blob) {
+                uuidBind(stmt, 1, students[i % 50]);
+            } else {
+                sqlite3_bind_text(stmt, 1, students[i % 50], -1, SQLITE_STATIC);
+            }
+            sqlite3_bind_int(stmt, 2, i % 500);
+            sqlite3_bind_int(stmt, 3, i % 2);
+            sqlite3_bind_int(stmt, 4, i % 2 ? 10 : 0);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_exec(db, "COMMIT", NULL, NULL, NULL);
+
+        sqlite3_stmt* count = NULL;
+        if (sqlite3_prepare_v2(db, "PRAGMA page_count", -1, &count, NULL) == SQLITE_OK
+            && sqlite3_step(count) == SQLITE_ROW) {
+            pages = sqlite3_column_int(count, 0);
+        }
+        sqlite3_finalize(count);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    remove_db_files(path);
+    return pages;
+}
+
+/**
+ * @brief UUID 生成速度，以及随机（v4）与按时间排序（v7）的主键插入时分配的页数
+ */
+static int bench_uuid(void) {
+    char prev[UUID_STR_LEN], cur[UUID_STR_LEN];
+    int n = iterations * 50;
+    int ok = 1;
+
+    long long start = timerNowNs();
+    for (int i = 0; i < n; i++) uuidV4(cur);
+    report("uuidV4", n, timerNowNs() - start);
+
+    uuidV7(prev);
+    start = timerNowNs();
+    for (int i = 0; i < n; i++) {
+        uuidV7(cur);
+        if (strcmp(prev, cur) >= 0) ok = 0;
+        memcpy(prev, cur, UUID_STR_LEN);
+    }
+    report("uuidV7 (with order check)", n, timerNowNs() - start);
+    if (!ok) fprintf(stderr, "uuidV7 is not strictly increasing\n");
+
+    static void (*const gens[])(char*) = {uuidV4, uuidV7};
+    static const char* labels[] = {"insert v4 key", "insert v7 key"};
+    int rows = iterations * 5;
+    for (int g = 0; g < 2; g++) {
+        long long ns = 0;
+        int written = 0;
+        int pages = insert_uuid_keys(gens[g], rows, &ns, &written);
+        if (pages < 0) return 1;
+        report(labels[g], rows, ns);
+        printf("  page splits %.2f / 1000 inserts, pages written %.2f / insert\n",
+               pages * 1000.0 / rows, (double)written / rows);
+        char label[64];
+        snprintf(label, sizeof(label), "%s: page splits per 1000 inserts", labels[g]);
+        emit_metric(label, pages * 1000.0 / rows);
+        snprintf(label, sizeof(label), "%s: pages written per insert", labels[g]);
+        emit_metric(label, (double)written / rows);
+    }
+
+    int text_pages = answer_table_pages(0, rows);
+    int blob_pages = answer_table_pages(1, rows);
+    if (text_pages <= 0 || blob_pages <= 0) return 1;
+    printf("answer_records with %d rows: %d pages (TEXT uuid), %d pages (BLOB uuid), %.0f%%\n",
+           rows, text_pages, blob_pages, blob_pages * 100.0 / text_pages);
+    emit_metric("answer_records pages (TEXT uuid)", text_pages);
+    emit_metric("answer_records pages (BLOB uuid)", blob_pages);
+    return ok ? 0 : 1;
+}
+
+struct BenchCase {
+    const char* name;
+    int (*run)(void);   /* 返回 0 表示成功 */
+};
+
+static const struct BenchCase cases[] = {
+    {"conn", bench_conn},
+    {"stmt", bench_stmt},
+    {"quiz", bench_quiz},
+    {"profiles", bench_profiles},
+    {"plans", bench_plans},
+    {"import", bench_import},
+    {"dict", bench_dict},
+    {"api", bench_api},
+    {"qcache", bench_qcache},
+    {"list", bench_list},
+    {"sample", bench_sample},
+    {"review", bench_review},
+    {"difficulty", bench_difficulty},
+    {"grading", bench_grading},
+    {"search", bench_search},
+    {"names", bench_names},
+    {"roster", bench_roster},
+    {"purge", bench_purge},
+    {"gen", bench_gen},
+    {"uuid", bench_uuid},
+};
+
+/**
+ * @brief 解析 --name=value 形式的选项，匹配时返回 value
+ */
+static const char* option_value(const char* arg, const char* name) {
+    size_t len = strlen(name);
+    return strncmp(arg, name, len) == 0 && arg[len] == '=' ? arg + len + 1 : NULL;
+}
+
+int main(int argc, char** argv) {
+    const char* which = "all";
+    const char* json_path = NULL;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        const char* v;
+        if ((v = option_value(argv[i], "--users")) != NULL) seed_users = atoi(v);
+        else if ((v = option_value(argv[i], "--questions")) != NULL) seed_questions = atoi(v);
+        else if ((v = option_value(argv[i], "--answers")) != NULL) seed_answers = atoi(v);
+        else if ((v = option_value(argv[i], "--json")) != NULL) json_path = v;
+        else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        } else if (positional++ == 0) which = argv[i];
+        else iterations = atoi(argv[i]);
+    }
+    if (iterations <= 0) iterations = 1;
+    if (seed_users <= 0) seed_users = 1;
+    if (seed_questions <= 0) seed_questions = 1;
+    if (seed_answers < 0) seed_answers = 0;
+    if (json_path) {
+        json_out = fopen(json_path, "a");
+        if (!json_out) {
+            fprintf(stderr, "cannot open %s\n", json_path);
+            return 1;
+        }
+        fprintf(json_out, "{\"run\":%lld,\"iterations\":%d,\"users\":%d,\"questions\":%d,\"answers\":%d}\n",
+                (long long)time(NULL), iterations, seed_users, seed_questions, seed_answers);
+    }
+
+    if (!dbOpen(BENCH_DB)) return 1;
+
+    int ran = 0, failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (strcmp(which, "all") != 0 && strcmp(which, cases[i].name) != 0) continue;
+        printf("== %s ==\n", cases[i].name);
+        current_case = cases[i].name;
+        if (cases[i].run() != 0) {
+            fprintf(stderr, "case %s failed\n", cases[i].name);
+            failed++;
+        }
+        ran++;
+    }
+    dbClose();
+    if (json_out) fclose(json_out);
+
+    if (!ran) {
+        fprintf(stderr, "unknown case: %s\n", which);
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
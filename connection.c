@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "connection.h"
+#include "database.h"
+#include "load_test_data.h"
+#include "question_cache.h"
+#include "search.h"
+#include "stmt_cache.h"
+#include "uuid.h"
+
+static char db_path[260] = DB_NAME;
+static sqlite3* shared_db = NULL;
+
+/* 连接池：连接惰性打开，in_use 标记是否已被借出 */
+static sqlite3* pool_db[DB_POOL_SIZE];
+static int pool_in_use[DB_POOL_SIZE];
+
+/* 性能配置档，在每个新打开的连接上执行 */
+struct DbProfile {
+    const char* name;
+    const char* synchronous;
+    int cache_size;          /* 负数表示以 KiB 为单位 */
+    long long mmap_size;     /* 字节，0 表示不使用 mmap */
+    const char* temp_store;
+    int busy_timeout;        /* 毫秒 */
+};
+
+static const struct DbProfile profiles[] = {
+    /* 每次提交都完整同步，断电也不丢失已提交的答题记录 */
+    {"safe",     "FULL",   -2000,  0,                  "DEFAULT", 5000},
+    /* WAL 下 NORMAL 只在检查点同步，断电可能丢失最近的提交但不会损坏数据库 */
+    {"balanced", "NORMAL", -16384, 64LL * 1024 * 1024, "MEMORY",  5000},
+    /* 不做同步，仅用于测试数据生成与基准测试 */
+    {"fast",     "OFF",    -65536, 256LL * 1024 * 1024, "MEMORY", 1000},
+};
+
+static const struct DbProfile* current_profile = &profiles[1];
+
+/**
+ * @brief 在连接上应用当前的性能配置档
+ * @return 成功返回 1，失败返回 0
+ */
+static int apply_profile(sqlite3* db) {
+    char sql[512];
+    const struct DbProfile* p = current_profile;
+    /* auto_vacuum 只对尚未建表的新数据库生效，且必须在切换到 WAL 之前设置 */
+    snprintf(sql, sizeof(sql),
+             "PRAGMA auto_vacuum=INCREMENTAL;"
+             "PRAGMA journal_mode=WAL;"
+             "PRAGMA synchronous=%s;"
+             "PRAGMA cache_size=%d;"
+             "PRAGMA mmap_size=%lld;"
+             "PRAGMA temp_store=%s;",
+             p->synchronous, p->cache_size, p->mmap_size, p->temp_store);
+
+    sqlite3_busy_timeout(db, p->busy_timeout);
+    char* errmsg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &errmsg) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Apply profile %s failed: %s\n", p->name, errmsg);
+        sqlite3_free(errmsg);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 打开一个新的数据库连接
+ * @return 成功返回连接，失败返回 NULL
+ */
+static sqlite3* open_connection(void) {
+    sqlite3* db = NULL;
+    /* 允许 URI 文件名，ATTACH 词库时需要以 URI 指定只读与 immutable */
+    int rc = sqlite3_open_v2(db_path, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Cannot open database: %s\n", db ? sqlite3_errmsg(db) : "out of memory");
+        if (db) sqlite3_close(db);
+        return NULL;
+    }
+    /* 迁移需要 uuid_blob() 把旧的文本 UUID 转为 BLOB，因此在每个连接上注册 */
+    if (!apply_profile(db) || !uuidRegisterFunctions(db)) {
+        sqlite3_close(db);
+        return NULL;
+    }
+    return db;
+}
+
+/**
+ * @brief 选择性能配置档（safe / balanced / fast），需在 dbOpen 之前调用
+ * @return 名称有效返回 1，否则返回 0
+ */
+int dbSetProfile(const char* name) {
+    if (!name) return 0;
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+        if (strcmp(profiles[i].name, name) == 0) {
+            current_profile = &profiles[i];
+            return 1;
+        }
+    }
+    fprintf(stderr, "[ERROR] Unknown profile: %s\n", name);
+    return 0;
+}
+
+const char* dbProfileName(void) {
+    return current_profile->name;
+}
+
+/**
+ * @brief 打开共享连接，并确保表结构存在
+ * @param path 数据库文件名，为 NULL 时使用 DB_NAME
+ * @return 成功返回 1，失败返回 0
+ */
+int dbOpen(const char* path) {
+    if (shared_db) return 1;
+    if (path) {
+        strncpy(db_path, path, sizeof(db_path) - 1);
+        db_path[sizeof(db_path) - 1] = '\0';
+    }
+
+    shared_db = open_connection();
+    if (!shared_db) return 0;
+
+    if (!initDatabase(shared_db)) {
+        sqlite3_close(shared_db);
+        shared_db = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 获取共享连接，整个进程生命周期内复用同一个句柄
+ */
+sqlite3* dbGet(void) {
+    if (!shared_db && !dbOpen(NULL)) return NULL;
+    return shared_db;
+}
+
+/**
+ * @brief 关闭共享连接与连接池
+ */
+void dbClose(void) {
+    stmtCacheClear();
+    questionCacheClear();
+    searchClear();
+    for (int i = 0; i < DB_POOL_SIZE; i++) {
+        if (pool_db[i]) {
+            sqlite3_close(pool_db[i]);
+            pool_db[i] = NULL;
+        }
+        pool_in_use[i] = 0;
+    }
+    if (shared_db) {
+        sqlite3_close(shared_db);
+        shared_db = NULL;
+    }
+}
+
+/**
+ * @brief 执行一条无结果的缓存语句
+ */
+static int exec_cached(enum StmtId id) {
+    sqlite3_stmt* stmt = stmtGet(id);
+    if (!stmt) return 0;
+    int rc = sqlite3_step(stmt);
+    stmtRelease(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Transaction failed: %s\n", sqlite3_errmsg(shared_db));
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 开始写事务（BEGIN IMMEDIATE，立即取得写锁）
+ */
+int dbBegin(void) {
+    return exec_cached(STMT_BEGIN);
+}
+
+int dbCommit(void) {
+    return exec_cached(STMT_COMMIT);
+}
+
+void dbRollback(void) {
+    if (shared_db && !sqlite3_get_autocommit(shared_db)) exec_cached(STMT_ROLLBACK);
+}
+
+/**
+ * @brief 读取一个整数 PRAGMA，失败返回 -1
+ */
+static int pragma_int(sqlite3* db, const char* sql) {
+    sqlite3_stmt* stmt = NULL;
+    int value = -1;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        value = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+/**
+ * @brief 把空闲页归还给文件系统（auto_vacuum = INCREMENTAL）
+ * 每次 incremental_vacuum 最多处理 RECLAIM_STEP_PAGES 页并单独提交，
+ * 步与步之间其他连接可以写入，不像 VACUUM 那样在整个过程中持有写锁并重写整个文件
+ * @return 归还的页数，失败返回 -1
+ */
+int dbReclaimSpace(void) {
+    sqlite3* db = dbGet();
+    if (!db) return -1;
+    int before = pragma_int(db, "PRAGMA freelist_count");
+    int left = before;
+    char sql[64];
+    snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d)", RECLAIM_STEP_PAGES);
+    while (left > 0) {
+        if (sqlite3_exec(db, sql, NULL, NULL, NULL) != SQLITE_OK) {
+            fprintf(stderr, "[ERROR] Incremental vacuum failed: %s\n", sqlite3_errmsg(db));
+            return -1;
+        }
+        int now = pragma_int(db, "PRAGMA freelist_count");
+        /* 不是 INCREMENTAL 模式时 incremental_vacuum 什么也不做 */
+        if (now < 0 || now >= left) break;
+        left = now;
+    }
+    return before - left;
+}
+
+/**
+ * @brief 从连接池借出一个连接
+ * 借出与归还由 SQLite 自带的静态互斥量保护，可在多个线程中调用
+ */
+sqlite3* dbPoolAcquire(void) {
+    if (!dbGet()) return NULL;
+
+    sqlite3_mutex* mutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_APP1);
+    sqlite3* db = NULL;
+    sqlite3_mutex_enter(mutex);
+    for (int i = 0; i < DB_POOL_SIZE; i++) {
+        if (pool_in_use[i]) continue;
+        if (!pool_db[i]) pool_db[i] = open_connection();
+        if (!pool_db[i]) break;
+        pool_in_use[i] = 1;
+        db = pool_db[i];
+        break;
+    }
+    sqlite3_mutex_leave(mutex);
+    return db;
+}
+
+/**
+ * @brief 归还连接
+ */
+void dbPoolRelease(sqlite3* db) {
+    if (!db) return;
+
+    sqlite3_mutex* mutex = sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_APP1);
+    sqlite3_mutex_enter(mutex);
+    for (int i = 0; i < DB_POOL_SIZE; i++) {
+        if (pool_db[i] == db) {
+            pool_in_use[i] = 0;
+            break;
+        }
+    }
+    sqlite3_mutex_leave(mutex);
+}
@@ -0,0 +1,49 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include "lib/sqlite3.h"
+
+/* 连接池中供工作线程使用的连接数量 */
+#define DB_POOL_SIZE 4
+
+/*
+ * 选择性能配置档：safe / balanced（默认）/ fast
+ * 均使用 WAL，区别在于 synchronous、cache_size、mmap_size 与 temp_store
+ * 需在 dbOpen 之前调用，之后打开的每个连接都会应用该配置
+ */
+int dbSetProfile(const char* name);
+const char* dbProfileName(void);
+
+/*
+ * 在程序启动时调用一次：打开共享连接并初始化表结构
+ * 成功返回 1，失败返回 0
+ */
+int dbOpen(const char* path);
+
+/* 获取进程内共享的数据库连接（若尚未打开则按 DB_NAME 惰性打开） */
+sqlite3* dbGet(void);
+
+/* 关闭共享连接以及连接池中的全部连接，在程序退出前调用 */
+void dbClose(void);
+
+/* 在共享连接上开始 / 提交 / 回滚写事务，成功返回 1 */
+int dbBegin(void);
+int dbCommit(void);
+void dbRollback(void);
+
+/* dbReclaimSpace 每一步（一个写事务）归还的最多页数 */
+#define RECLAIM_STEP_PAGES 256
+
+/*
+ * 分步执行 PRAGMA incremental_vacuum，把删除数据后的空闲页归还给文件系统，
+ * 返回归还的页数，失败返回 -1；用于大批删除之后，代替会阻塞其他连接的 VACUUM
+ */
+int dbReclaimSpace(void);
+
+/* 从连接池中借出一个连接（供工作线程使用），无空闲连接时返回 NULL */
+sqlite3* dbPoolAcquire(void);
+
+/* 将连接归还连接池 */
+void dbPoolRelease(sqlite3* db);
+
+#endif /* CONNECTION_H */
@@ -2,163 +2,274 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <signal.h>
 #include "database.h"
 #include "lib/sqlite3.h"
-#include "load_test_data.h"
+#include "connection.h"
+#include "stmt_cache.h"
+#include "grading.h"
+#include "question_cache.h"
+#include "quiz_sample.h"
+#include "review.h"
+#include "search.h"
+#include "uuid.h"
 
 /**
  * @brief 生成 UUID
  * @return UUID 字符串
  */
 char* generateUUID() {
-    char* uuid = (char*)malloc(37);
+    char* uuid = (char*)malloc(UUID_STR_LEN);
     if (!uuid) return NULL;
-    const char chars[] = "0123456789abcdef";
-    srand(time(NULL));
-    for(int i = 0; i < 8; i++) uuid[i] = chars[rand() % 16];
-    uuid[8] = '-';
-    for(int i = 9; i < 13; i++) uuid[i] = chars[rand() % 16];
-    uuid[13] = '-';
-    for(int i = 14; i < 18; i++) uuid[i] = chars[rand() % 16];
-    uuid[18] = '-';
-    for(int i = 19; i < 23; i++) uuid[i] = chars[rand() % 16];
-    uuid[23] = '-';
-    for(int i = 24; i < 36; i++) uuid[i] = chars[rand() % 16];
-    uuid[36] = '\0';
+    /* 按时间排序，新用户总是插入到 users 主键索引的末尾 */
+    uuidV7(uuid);
     return uuid;
 }
 
 
+/* 密码哈希的十进制字符串长度（含终止符），最大 4294967295 */
+#define PASSWORD_HASH_LEN 11
+
 /**
- * @brief 对用户输入的密码进行简单的 hash 加密
- * @return hash 算法之后的密码
+ * @brief 计算密码的 hash，写入调用方提供的缓冲区
  */
-char* hashPassword(const char* password) {
+static void hash_password_into(const char* password, char out[PASSWORD_HASH_LEN]) {
     unsigned int hash = 5381;
     for(int i = 0; password[i]; i++) {
         // 递推式 h[i + 1] = h[i] * 33 + password[i]
         hash = ((hash << 5) + hash) + password[i];
     }
-    // 分配 11 字节的内存，最大 4294967295
-    char* result = (char*)malloc(11);
+    sprintf(out, "%u", hash);
+}
+
+/**
+ * @brief 对用户输入的密码进行简单的 hash 加密
+ * @return hash 算法之后的密码
+ */
+char* hashPassword(const char* password) {
+    char* result = (char*)malloc(PASSWORD_HASH_LEN);
     if (!result) return NULL;
-    sprintf(result, "%u", hash);
+    hash_password_into(password, result);
     return result;
 }
 
-/* initDatabase 已迁移到 load_test_data.c */
+/* initDatabase 已迁移到 load_test_data.c，由 dbOpen 在程序启动时调用一次 */
 
 /**
  * @brief 创建用户
  * @return 新创建用户的 UUID
  */
 char* createUser(const char* username, const char* password, int level, const char* class_name, int num, const char* teacher_uuid) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+    sqlite3 *db = dbGet();
+    if (!db) {
         fprintf(stderr, "[ERROR] Cannot open database\n");
         return NULL;
     }
-    if (!initDatabase(db)) {
-        sqlite3_close(db);
-        return NULL;
-    }
     
     char* uuid = generateUUID();
     if (!uuid) {
-        sqlite3_close(db);
         return NULL;
     }
     
     char* pswd_hash = hashPassword(password);
     if (!pswd_hash) {
         free(uuid);
-        sqlite3_close(db);
         return NULL;
     }
     
-    const char* sql = "INSERT INTO users VALUES(?, ?, ?, ?, ?, ?, ?)";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = stmtGet(STMT_USER_INSERT);
+    if (!stmt) {
         fprintf(stderr, "[ERROR] Prepare SQL failed: %s\n", sqlite3_errmsg(db));
         free(pswd_hash);
         free(uuid);
-        sqlite3_close(db);
         return NULL;
     }
     
-    sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_STATIC);
+    uuidBind(stmt, 1, uuid);
     sqlite3_bind_text(stmt, 2, username, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, pswd_hash, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 4, level);
     sqlite3_bind_text(stmt, 5, class_name ? class_name : "", -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 6, num);
-    sqlite3_bind_text(stmt, 7, teacher_uuid ? teacher_uuid : "", -1, SQLITE_STATIC);
+    uuidBind(stmt, 7, teacher_uuid);
     
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         fprintf(stderr, "[ERROR] Insert user failed: %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
+        stmtRelease(stmt);
         free(pswd_hash);
         free(uuid);
-        sqlite3_close(db);
         return NULL;
     }
     
-    sqlite3_finalize(stmt);
+    stmtRelease(stmt);
     free(pswd_hash);
-    sqlite3_close(db);
     
     printf("[SUCCESS] User created: %s\n", username);
     return uuid;
 }
 
 /**
- * @brief 用户登录
+ * @brief 检查名单中的一行，不合法时返回 ROSTER_INVALID
+ * 名单只用于建立学生，管理员与教师仍需用 createUser 逐个创建
  */
-char* loginUser(const char* username, const char* password) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+static enum RosterStatus check_roster_entry(const struct RosterEntry* e) {
+    unsigned char teacher[16];
+    if (!e->username || !e->username[0] || !e->password || !e->password[0]) return ROSTER_INVALID;
+    if (e->level != 2) return ROSTER_INVALID;
+    if (e->teacher_uuid && e->teacher_uuid[0] && !uuidParse(e->teacher_uuid, teacher)) return ROSTER_INVALID;
+    return ROSTER_OK;
+}
+
+/**
+ * @brief 名单未能写入时，把原本合法的行标记为 ROSTER_FAILED
+ */
+static void fail_roster(struct RosterEntry* entries, int count) {
+    for (int i = 0; i < count; i++) {
+        if (entries[i].status == ROSTER_OK) {
+            entries[i].status = ROSTER_FAILED;
+            entries[i].uuid[0] = '\0';
+        }
+    }
+}
+
+/**
+ * @brief 按名单批量创建学生
+ * 先在事务之外校验各行并计算全部密码 hash，再在一个事务内用缓存的插入语句逐行插入；
+ * 用户名已存在（库中或名单前面的行）只使该行失败，其他错误回滚整个名单
+ * @param entries 名单，每行的 uuid 与 status 由本函数填写
+ * @return 新创建的用户数，失败时返回 -1（此时没有用户被创建，合法的行为 ROSTER_FAILED）
+ */
+int createUsersBulk(struct RosterEntry* entries, int count) {
+    if (count <= 0) return 0;
+    for (int i = 0; i < count; i++) {
+        entries[i].uuid[0] = '\0';
+        entries[i].status = check_roster_entry(&entries[i]);
+    }
+    
+    sqlite3 *db = dbGet();
+    if (!db) {
         fprintf(stderr, "[ERROR] Cannot open database\n");
-        return NULL;
+        fail_roster(entries, count);
+        return -1;
     }
     
-    const char* sql = "SELECT uuid, password_hash FROM users WHERE username = ?";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
-        return NULL;
+    char (*hashes)[PASSWORD_HASH_LEN] = malloc(sizeof(*hashes) * count);
+    if (!hashes) {
+        fail_roster(entries, count);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (entries[i].status == ROSTER_OK) hash_password_into(entries[i].password, hashes[i]);
+    }
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_USER_INSERT);
+    if (!stmt || !dbBegin()) {
+        fprintf(stderr, "[ERROR] Begin roster import failed: %s\n", sqlite3_errmsg(db));
+        stmtRelease(stmt);
+        free(hashes);
+        fail_roster(entries, count);
+        return -1;
+    }
+    
+    int created = 0;
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++) {
+        struct RosterEntry* e = &entries[i];
+        if (e->status != ROSTER_OK) continue;
+        
+        char uuid[UUID_STR_LEN];
+        uuidV7(uuid);
+        uuidBind(stmt, 1, uuid);
+        sqlite3_bind_text(stmt, 2, e->username, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, hashes[i], -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 4, e->level);
+        sqlite3_bind_text(stmt, 5, e->class_name ? e->class_name : "", -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 6, e->student_num);
+        uuidBind(stmt, 7, e->teacher_uuid);
+        
+        int rc = sqlite3_step(stmt);
+        int ext = sqlite3_extended_errcode(db);
+        sqlite3_reset(stmt);
+        if (rc == SQLITE_DONE) {
+            memcpy(e->uuid, uuid, UUID_STR_LEN);
+            created++;
+        } else if (ext == SQLITE_CONSTRAINT_UNIQUE) {
+            /* 失败的语句只撤销自身，事务继续 */
+            e->status = ROSTER_DUPLICATE;
+        } else {
+            fprintf(stderr, "[ERROR] Insert user failed: %s\n", sqlite3_errmsg(db));
+            ok = 0;
+        }
+    }
+    
+    stmtRelease(stmt);
+    free(hashes);
+    if (ok) ok = dbCommit();
+    if (!ok) {
+        dbRollback();
+        fail_roster(entries, count);
+        return -1;
+    }
+    return created;
+}
+
+/**
+ * @brief 用户登录，按用户名索引一次查出校验密码所需的哈希与用户资料
+ * @param profile 登录成功时写入用户资料，可为 NULL
+ * @return 若登录成功，返回 1
+ */
+int loginUserProfile(const char* username, const char* password, struct UserProfile* profile) {
+    sqlite3 *db = dbGet();
+    if (!db) {
+        fprintf(stderr, "[ERROR] Cannot open database\n");
+        return 0;
+    }
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_USER_LOGIN);
+    if (!stmt) {
+        return 0;
     }
     
     sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
     if (sqlite3_step(stmt) != SQLITE_ROW) {
         fprintf(stderr, "[ERROR] User not found\n");
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return NULL;
+        stmtRelease(stmt);
+        return 0;
     }
     
-    const char* stored_uuid = (const char*)sqlite3_column_text(stmt, 0);
     const char* stored_hash = (const char*)sqlite3_column_text(stmt, 1);
-    
     char* input_hash = hashPassword(password);
-    if (!input_hash || strcmp(stored_hash, input_hash) != 0) {
+    if (!input_hash || !stored_hash || strcmp(stored_hash, input_hash) != 0) {
         fprintf(stderr, "[ERROR] Password incorrect\n");
         if (input_hash) free(input_hash);
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return NULL;
+        stmtRelease(stmt);
+        return 0;
     }
-    
-    char* result = strdup(stored_uuid);
     free(input_hash);
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
     
-    return result;
+    if (profile) {
+        memset(profile, 0, sizeof(*profile));
+        uuidColumn(stmt, 0, profile->uuid);
+        snprintf(profile->username, sizeof(profile->username), "%s", username);
+        profile->level = sqlite3_column_int(stmt, 2);
+        const char* class_name = (const char*)sqlite3_column_text(stmt, 3);
+        snprintf(profile->class_name, sizeof(profile->class_name), "%s", class_name ? class_name : "");
+        profile->student_num = sqlite3_column_int(stmt, 4);
+        uuidColumn(stmt, 5, profile->teacher_uuid);
+    }
+    
+    stmtRelease(stmt);
+    return 1;
+}
+
+/**
+ * @brief 用户登录
+ * @return 用户的 UUID，需由调用方 free
+ */
+char* loginUser(const char* username, const char* password) {
+    struct UserProfile profile;
+    if (!loginUserProfile(username, password, &profile)) return NULL;
+    return strdup(profile.uuid);
 }
 
 /**
@@ -167,60 +278,97 @@ char* loginUser(const char* username, const char* password) {
  * @return 权限等级 0=Admin 1=Teacher 2=Student
  */
 int getUserLevel(const char* uuid) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) return -1;
-    
-    const char* sql = "SELECT user_level FROM users WHERE uuid = ?";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        sqlite3_close(db);
+    sqlite3 *db = dbGet();
+    if (!db) return -1;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_USER_LEVEL);
+    if (!stmt) {
         return -1;
     }
     
-    sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_STATIC);
+    uuidBind(stmt, 1, uuid);
     
     int level = -1;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         level = sqlite3_column_int(stmt, 0);
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     return level;
 }
 
 /**
- * @brief 删除用户
+ * @brief 删除用户，其答题记录、成绩汇总与复习状态由 trg_users_cascade 在同一语句中删除
  * @return 若删除成功，返回 1
  */
 int deleteUser(const char* uuid) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) return 0;
-    
-    const char* sql = "DELETE FROM users WHERE uuid = ?";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        sqlite3_close(db);
+    sqlite3 *db = dbGet();
+    if (!db) return 0;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_USER_DELETE);
+    if (!stmt) {
         return 0;
     }
     
-    sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_STATIC);
+    uuidBind(stmt, 1, uuid);
     if (sqlite3_step(stmt) != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+        stmtRelease(stmt);
         return 0;
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     printf("[SUCCESS] User deleted\n");
     return 1;
 }
 
+/**
+ * @brief 执行一条批量删除学生的语句（已绑定参数），之后分步归还空闲页
+ * 一条 DELETE 即一个事务，级联删除的答题记录等与学生一起提交或回滚
+ * @return 删除的学生数，失败返回 -1
+ */
+static int delete_students(sqlite3* db, sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    /* sqlite3_changes 不包括触发器中的删除 */
+    int deleted = rc == SQLITE_DONE ? sqlite3_changes(db) : -1;
+    if (deleted < 0) fprintf(stderr, "[ERROR] Delete students failed: %s\n", sqlite3_errmsg(db));
+    stmtRelease(stmt);
+    if (deleted > 0) dbReclaimSpace();
+    return deleted;
+}
+
+/**
+ * @brief 删除一个班级的全部学生及其答题数据
+ * @return 删除的学生数，失败返回 -1
+ */
+int deleteUsersByClass(const char* class_name) {
+    sqlite3 *db = dbGet();
+    if (!db) return -1;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_USERS_DELETE_BY_CLASS);
+    if (!stmt) {
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, class_name, -1, SQLITE_STATIC);
+    return delete_students(db, stmt);
+}
+
+/**
+ * @brief 删除学号在 [min_num, max_num] 之间的全部学生及其答题数据
+ * @return 删除的学生数，失败返回 -1
+ */
+int deleteUsersByStudentNumRange(int min_num, int max_num) {
+    sqlite3 *db = dbGet();
+    if (!db) return -1;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_USERS_DELETE_BY_NUM_RANGE);
+    if (!stmt) {
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, min_num);
+    sqlite3_bind_int(stmt, 2, max_num);
+    return delete_students(db, stmt);
+}
+
 /**
  * @brief 添加单个题目
  * @param word 英文单词
@@ -228,19 +376,14 @@ int deleteUser(const char* uuid) {
  * @return 若添加成功，返回 1
  */
 int addSingleQuestion(const char* word, const char* translate) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+    sqlite3 *db = dbGet();
+    if (!db) {
         fprintf(stderr, "[ERROR] Cannot open database\n");
         return 0;
     }
     
-    const char* sql = "INSERT INTO questions (word, translate) VALUES (?, ?)";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_INSERT);
+    if (!stmt) {
         return 0;
     }
     
@@ -249,85 +392,171 @@ int addSingleQuestion(const char* word, const char* translate) {
     
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         fprintf(stderr, "[ERROR] Add question failed\n");
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+        stmtRelease(stmt);
         return 0;
     } else {
+        /* 只把新题目加入题库缓存与搜索索引，不重新读取整个题库 */
+        searchQuestionAdded(questionCacheAdded((int)sqlite3_last_insert_rowid(db), word, translate));
         printf("[SUCCESS] Question added\n");
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     return 1;
 }
 
+/* 批量导入时每次从文件读取的字节数 */
+#define IMPORT_READ_SIZE (1 << 20)
+
 /**
- * @brief 从 timu.txt 中批量添加题目
- * @param source 文件名（"timu.txt"）
- * @return 若添加成功，返回 1
+ * @brief 导入一行 "word translate"（以 tab 或 space 分隔），line 不含换行符
+ * 单词已存在时更新其翻译；翻译相同或格式错误的行计入 skipped
  */
-int addQuestion(const char* source) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
-        fprintf(stderr, "[ERROR] Cannot open database\n");
-        return 0;
+static void import_line(sqlite3* db, sqlite3_stmt* stmt, const char* line, size_t len, struct ImportStats* st) {
+    while (len > 0 && line[len - 1] == '\r') len--;
+    if (len == 0) return;
+    if (line[0] == '#') {
+        /* exportQuestionsToFile 写出的注释行 */
+        st->skipped++;
+        return;
     }
+    
+    const char* delim = memchr(line, '\t', len);
+    if (!delim) delim = memchr(line, ' ', len);
+    const char* end = line + len;
+    const char* translate = delim ? delim + 1 : end;
+    while (translate < end && (*translate == ' ' || *translate == '\t')) translate++;
+    if (!delim || delim == line || translate == end) {
+        st->skipped++;
+        return;
+    }
+    
+    sqlite3_bind_text(stmt, 1, line, (int)(delim - line), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, translate, (int)(end - translate), SQLITE_STATIC);
+    
+    /* 新插入的行会改变 last_insert_rowid，而 ON CONFLICT 更新不会 */
+    sqlite3_int64 last_rowid = sqlite3_last_insert_rowid(db);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Insert question failed: %s\n", sqlite3_errmsg(db));
+        st->skipped++;
+    } else if (sqlite3_changes(db) == 0) {
+        st->skipped++;
+    } else if (sqlite3_last_insert_rowid(db) != last_rowid) {
+        st->inserted++;
+    } else {
+        st->updated++;
+    }
+}
 
-    const char* sql = "INSERT INTO questions (word, translate) VALUES (?, ?)";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
+/**
+ * @brief 批量导入题目文件
+ * 以大块缓冲读取文件，每 IMPORT_CHUNK_ROWS 行提交一次事务，重复的单词按 ON CONFLICT 更新翻译
+ * @param source 题目文件名
+ * @param stats 输出插入、更新、跳过的行数，可为 NULL
+ * @return 若文件处理完成，返回 1
+ */
+int importQuestionsBulk(const char* source, struct ImportStats* stats) {
+    struct ImportStats st = {0, 0, 0};
+    if (stats) *stats = st;
+    
+    sqlite3 *db = dbGet();
+    if (!db) {
+        fprintf(stderr, "[ERROR] Cannot open database\n");
         return 0;
     }
-
-    FILE* f = fopen(source, "r");
+    
+    FILE* f = fopen(source, "rb");
     if (!f) {
-        fprintf(stderr, "[ERROR] Cannot open source file: timu.txt\n");
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+        fprintf(stderr, "[ERROR] Cannot open source file: %s\n", source);
         return 0;
     }
-
-    char line[512];
-    int inserted = 0;
-    while (fgets(line, sizeof(line), f)) {
-        line[strcspn(line, "\r\n")] = 0;
-        if (line[0] == '\0') continue;
-
-        /* 支持以 tab 或 space 分隔的 "word translate" 格式 */
-        char* delim = strchr(line, '\t');
-        if (!delim) delim = strchr(line, ' ');
-        if (!delim) continue;
-
-        *delim = '\0';
-        char* word = line;
-        char* translate = delim + 1;
-        while (*translate == ' ' || *translate == '\t') translate++;
-
-        sqlite3_bind_text(stmt, 1, word, -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, translate, -1, SQLITE_STATIC);
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            fprintf(stderr, "[ERROR] Insert question failed: %s\n", sqlite3_errmsg(db));
-            sqlite3_reset(stmt);
-            continue;
+    
+    char* buf = (char*)malloc(IMPORT_READ_SIZE);
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_UPSERT);
+    if (!buf || !stmt || !dbBegin()) {
+        free(buf);
+        stmtRelease(stmt);
+        fclose(f);
+        return 0;
+    }
+    
+    size_t have = 0;
+    int rows_in_tx = 0;
+    int first_chunk = 1;
+    int discarding = 0;   /* 当前行超过缓冲区大小，丢弃到下一个换行符 */
+    int ok = 1;
+    
+    while (ok) {
+        size_t want = IMPORT_READ_SIZE - have;
+        size_t n = fread(buf + have, 1, want, f);
+        int eof = n < want;
+        char* p = buf;
+        char* end = buf + have + n;
+        
+        if (first_chunk) {
+            /* 跳过 UTF-8 BOM */
+            if (end - p >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+            first_chunk = 0;
+        }
+        if (discarding) {
+            char* nl = memchr(p, '\n', end - p);
+            p = nl ? nl + 1 : end;
+            discarding = nl == NULL;
+        }
+        
+        char* nl;
+        while ((nl = memchr(p, '\n', end - p)) != NULL) {
+            import_line(db, stmt, p, nl - p, &st);
+            p = nl + 1;
+            if (++rows_in_tx >= IMPORT_CHUNK_ROWS) {
+                ok = dbCommit() && dbBegin();
+                rows_in_tx = 0;
+                if (!ok) break;
+            }
+        }
+        
+        have = end - p;
+        memmove(buf, p, have);
+        if (eof) {
+            if (ok && have > 0 && !discarding) import_line(db, stmt, buf, have, &st);
+            break;
+        }
+        if (have == IMPORT_READ_SIZE) {
+            st.skipped++;
+            have = 0;
+            discarding = 1;
         }
-        inserted++;
-        sqlite3_reset(stmt);
     }
-
+    
+    stmtRelease(stmt);
+    if (ok) ok = dbCommit();
+    if (!ok) dbRollback();
+    /* 中途失败时之前的分块可能已提交，无论成败都让缓存失效 */
+    questionCacheInvalidate();
+    free(buf);
     fclose(f);
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    
+    if (stats) *stats = st;
+    return ok;
+}
 
-    if (inserted > 0) {
-        printf("[SUCCESS] %d questions added\n", inserted);
+/**
+ * @brief 从 timu.txt 中批量添加题目
+ * @param source 文件名（"timu.txt"）
+ * @return 若添加成功，返回 1
+ */
+int addQuestion(const char* source) {
+    struct ImportStats st;
+    if (!importQuestionsBulk(source, &st)) {
+        return 0;
+    }
+    
+    if (st.inserted + st.updated > 0) {
+        printf("[SUCCESS] %d questions added, %d updated, %d skipped\n", st.inserted, st.updated, st.skipped);
         return 1;
     } else {
-        fprintf(stderr, "[WARN] No questions were added\n");
+        fprintf(stderr, "[WARN] No questions were added (%d skipped)\n", st.skipped);
         return 0;
     }
 }
@@ -337,78 +566,48 @@ int addQuestion(const char* source) {
  * @return 若删除成功，返回 1
  */
 int deleteSingleQuestion(int qid) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) return 0;
-    
-    const char* sql = "DELETE FROM questions WHERE qid = ?";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        sqlite3_close(db);
+    sqlite3 *db = dbGet();
+    if (!db) return 0;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_DELETE);
+    if (!stmt) {
         return 0;
     }
     
     sqlite3_bind_int(stmt, 1, qid);
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         fprintf(stderr, "[ERROR] Delete question failed\n");
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+        stmtRelease(stmt);
         return 0;
     } else {
+        searchQuestionRemoved(questionCacheDeleted(qid));
         printf("[SUCCESS] Question deleted\n");
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     return 1;
 }
 
 /**
- * @brief 
- * @return 将生成的试卷放入链表
+ * @brief 取得全部题目（按 qid 升序），题目来自进程内的题库缓存，题库未变化时不访问数据库
+ * 兼容旧接口：把紧凑的 QuestionSet 展开为 struct Question 数组，新代码直接使用 questionCacheGet
+ * @return 题目数组，由调用方用 freeQuestions 释放
  */
 struct Question* getQuestions(int* count) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
-        *count = 0;
-        return NULL;
-    }
-    
-    const char* sql = "SELECT COUNT(*) FROM questions";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK || sqlite3_step(stmt) != SQLITE_ROW) {
-        *count = 0;
-        if (stmt) sqlite3_finalize(stmt);
-        sqlite3_close(db);
+    *count = 0;
+    const struct QuestionSet* set = questionCacheGet();
+    if (!set || set->count == 0) {
         return NULL;
     }
     
-    *count = sqlite3_column_int(stmt, 0);
-    sqlite3_finalize(stmt);
-    
-    if (*count == 0) {
-        sqlite3_close(db);
+    struct Question* questions = (struct Question*)malloc(sizeof(struct Question) * set->count);
+    if (!questions) {
         return NULL;
     }
-    
-    // 为试卷（链表）分配内存
-    struct Question* questions = (struct Question*)malloc(sizeof(struct Question) * (*count));
-    sql = "SELECT qid, word, translate FROM questions";
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    
-    int idx = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && idx < *count) {
-        questions[idx].qid = sqlite3_column_int(stmt, 0);
-        strncpy(questions[idx].word, (const char*)sqlite3_column_text(stmt, 1), MAX_WORD_LENGTH - 1);
-        strncpy(questions[idx].translate, (const char*)sqlite3_column_text(stmt, 2), MAX_TRANS_LENGTH - 1);
-        idx++;
+    for (int i = 0; i < set->count; i++) {
+        questionSetToQuestion(set, i, &questions[i]);
     }
-    
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    *count = set->count;
     return questions;
 }
 
@@ -419,227 +618,403 @@ void freeQuestions(struct Question* q) {
     if (q) free(q);
 }
 
-/** 
- * @brief 生成带下划线的单词提示（puzzled），例如 "conversation" -> "conver_ation"
+/* 答题记录写缓冲 */
+struct PendingAnswer {
+    char student_uuid[37];
+    int qid;
+    char user_answer[MAX_TRANS_LENGTH];
+    int is_correct;
+    int score;
+};
+
+static struct PendingAnswer pending_answers[ANSWER_BATCH_SIZE];
+static int pending_count = 0;
+static int answer_session_active = 0;
+
+/**
+ * @brief 向 answer_records 插入一条记录（不负责事务）
+ * @return 若插入成功，返回 1
  */
-static void make_puzzled(const char* word, char* out, int out_size) {
-    if (!word || !out || out_size <= 0) return;
-    size_t len = strlen(word);
-    if (len + 1 > (size_t)out_size) {
-        // 如果输出缓冲区太小，截断复制
-        strncpy(out, word, out_size - 1);
-        out[out_size - 1] = '\0';
-        return;
+static int insert_answer(const char* student_uuid, int qid, const char* user_answer, int is_correct, int score) {
+    sqlite3_stmt* stmt = stmtGet(STMT_ANSWER_INSERT);
+    if (!stmt) {
+        return 0;
     }
-    strcpy(out, word);
-    if (len <= 3) {
-        /* 对短单词也随机替换一个字符为 '_' */
-        int idx = (int)(rand() % (int)len);
-        out[idx] = '_';
-        return;
+    
+    uuidBind(stmt, 1, student_uuid);
+    sqlite3_bind_int(stmt, 2, qid);
+    sqlite3_bind_text(stmt, 3, user_answer, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, is_correct);
+    sqlite3_bind_int(stmt, 5, score);
+    
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Save answer failed: %s\n", sqlite3_errmsg(dbGet()));
+        stmtRelease(stmt);
+        return 0;
     }
-    /* 选择中间附近的一个字符替换为 '_'，避免替换首尾 */
-    int mid = (int)len / 2;
-    int shift = rand() % 3 - 1; // -1,0,1
-    int idx = mid + shift;
-    if (idx <= 0) idx = 1;
-    if (idx >= (int)len - 1) idx = (int)len - 2;
-    out[idx] = '_';
+    
+    stmtRelease(stmt);
+    return 1;
 }
 
 /**
  * @brief 保存答题记录
+ * 若处于答题会话中，只写入内存缓冲，缓冲满时批量提交
  * @param student_uuid 学生的 UUID
  * @param qid 题目 ID
  * @param user_answer 用户的答案
  * @param is_correct 是否正确
- * @param score 该题分数
+ * @param score 所得分数
  * @return 若保存成功，返回 1
  */
 int saveAnswerRecord(const char* student_uuid, int qid, const char* user_answer, int is_correct, int score) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+    sqlite3 *db = dbGet();
+    if (!db) {
         fprintf(stderr, "[ERROR] Cannot open database\n");
         return 0;
     }
     
-    const char* sql = "INSERT INTO answer_records (student_uuid, qid, user_answer, is_correct, score) VALUES (?, ?, ?, ?, ?)";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
-        return 0;
+    if (!answer_session_active) {
+        return insert_answer(student_uuid, qid, user_answer, is_correct, score);
     }
     
-    sqlite3_bind_text(stmt, 1, student_uuid, -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, qid);
-    sqlite3_bind_text(stmt, 3, user_answer, -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 4, is_correct);
-    sqlite3_bind_int(stmt, 5, score);
-    
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
-        fprintf(stderr, "[ERROR] Save answer failed\n");
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+    if (pending_count >= ANSWER_BATCH_SIZE && !flushAnswerSession()) {
         return 0;
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    struct PendingAnswer* row = &pending_answers[pending_count];
+    strncpy(row->student_uuid, student_uuid, sizeof(row->student_uuid) - 1);
+    row->student_uuid[sizeof(row->student_uuid) - 1] = '\0';
+    strncpy(row->user_answer, user_answer ? user_answer : "", sizeof(row->user_answer) - 1);
+    row->user_answer[sizeof(row->user_answer) - 1] = '\0';
+    row->qid = qid;
+    row->is_correct = is_correct;
+    row->score = score;
+    pending_count++;
+    
+    if (pending_count >= ANSWER_BATCH_SIZE) {
+        flushAnswerSession();
+    }
     return 1;
 }
 
 /**
- * @brief 按姓名获取成绩
+ * @brief 在一个事务内提交缓冲中的全部答题记录
+ * 提交失败时保留缓冲内容，下一次 flush 时重试
+ * @return 若提交成功（或缓冲为空），返回 1
  */
-struct GradeInfo* getGradesByName(const char* username, int* count) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
-        *count = 0;
-        return NULL;
+int flushAnswerSession(void) {
+    if (pending_count == 0) return 1;
+    if (!dbBegin()) return 0;
+    
+    for (int i = 0; i < pending_count; i++) {
+        struct PendingAnswer* row = &pending_answers[i];
+        if (!insert_answer(row->student_uuid, row->qid, row->user_answer, row->is_correct, row->score)) {
+            dbRollback();
+            return 0;
+        }
     }
     
-    const char* sql = "SELECT u.uuid, u.username, u.class_name, u.student_num, SUM(ar.score), COUNT(ar.aid), CAST(SUM(ar.is_correct) AS FLOAT) / COUNT(ar.aid) FROM users u LEFT JOIN answer_records ar ON u.uuid = ar.student_uuid WHERE u.username LIKE ? GROUP BY u.uuid";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
-        *count = 0;
-        return NULL;
+    if (!dbCommit()) {
+        dbRollback();
+        return 0;
     }
-    
-    char pattern[110];
-    snprintf(pattern, sizeof(pattern), "%%%s%%", username);
-    sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_STATIC);
-    
-    int capacity = 10;
-    struct GradeInfo* grades = (struct GradeInfo*)malloc(sizeof(struct GradeInfo) * capacity);
-    *count = 0;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        if (*count >= capacity) {
-            capacity *= 2;
-            grades = (struct GradeInfo*)realloc(grades, sizeof(struct GradeInfo) * capacity);
-        }
-        
-        strncpy(grades[*count].uuid, (const char*)sqlite3_column_text(stmt, 0), 36);
-        strncpy(grades[*count].username, (const char*)sqlite3_column_text(stmt, 1), 99);
-        strncpy(grades[*count].class_name, (const char*)sqlite3_column_text(stmt, 2), 49);
-        grades[*count].student_num = sqlite3_column_int(stmt, 3);
-        grades[*count].total_score = sqlite3_column_int(stmt, 4);
-        grades[*count].total_questions = sqlite3_column_int(stmt, 5);
-        grades[*count].accuracy = sqlite3_column_double(stmt, 6);
-        
-        (*count)++;
+    pending_count = 0;
+    return 1;
+}
+
+/* 答题会话期间收到的 SIGINT / SIGTERM，0 表示没有；信号处理函数只设置这个标志 */
+static volatile sig_atomic_t answer_signal = 0;
+
+/* 会话开始前的信号处理方式，会话结束时恢复 */
+#ifdef _WIN32
+static void (*saved_sigint)(int);
+static void (*saved_sigterm)(int);
+#else
+static struct sigaction saved_sigint, saved_sigterm;
+#endif
+
+/**
+ * @brief 进程正常退出前提交尚未写入的答题记录
+ */
+static void flush_answers_at_exit(void) {
+    flushAnswerSession();
+}
+
+/**
+ * @brief 测验中途收到 Ctrl+C 等信号时只记下信号，由测验循环检查后提交并结束
+ */
+static void on_quiz_signal(int sig) {
+    answer_signal = sig;
+}
+
+/**
+ * @brief 安装会话期间的信号处理函数，保存原来的处理方式
+ */
+static void install_quiz_signals(void) {
+#ifdef _WIN32
+    saved_sigint = signal(SIGINT, on_quiz_signal);
+    saved_sigterm = signal(SIGTERM, on_quiz_signal);
+#else
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_quiz_signal;
+    sigemptyset(&sa.sa_mask);
+    /* 不设 SA_RESTART：阻塞在 fgets 中的读取被打断后立即返回，测验循环随即检查标志 */
+    sa.sa_flags = 0;
+    sigaction(SIGINT, &sa, &saved_sigint);
+    sigaction(SIGTERM, &sa, &saved_sigterm);
+#endif
+}
+
+static void restore_quiz_signals(void) {
+#ifdef _WIN32
+    signal(SIGINT, saved_sigint);
+    signal(SIGTERM, saved_sigterm);
+#else
+    sigaction(SIGINT, &saved_sigint, NULL);
+    sigaction(SIGTERM, &saved_sigterm, NULL);
+#endif
+}
+
+/**
+ * @brief 开始答题会话
+ */
+void beginAnswerSession(void) {
+    static int exit_hook_installed = 0;
+    if (!exit_hook_installed) {
+        atexit(flush_answers_at_exit);
+        exit_hook_installed = 1;
     }
-    
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return grades;
+    if (!answer_session_active) {
+        answer_signal = 0;
+        install_quiz_signals();
+    }
+    answer_session_active = 1;
 }
 
 /**
- * @brief 按班级获取成绩
+ * @brief 结束答题会话并提交剩余记录，恢复会话开始前的信号处理方式
+ * @return 若全部记录提交成功，返回 1
  */
-struct GradeInfo* getGradesByClass(const char* class_name, int* count) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
-        *count = 0;
-        return NULL;
+int endAnswerSession(void) {
+    int ok = flushAnswerSession();
+    if (answer_session_active) restore_quiz_signals();
+    answer_session_active = 0;
+    return ok;
+}
+
+/**
+ * @brief 当前（或最近一次）答题会话期间收到的终止信号
+ * @return 信号编号，没有收到时返回 0
+ */
+int answerSessionSignal(void) {
+    return answer_signal;
+}
+
+/**
+ * @brief 逐行读取成绩查询的结果并交给回调
+ * 语句的前几个参数由调用方绑定，limit / offset 绑定在最后两个参数上
+ * @return 回调处理的行数；读取出错或回调返回负数时返回 -1
+ */
+static int visit_grades(sqlite3_stmt* stmt, int limit, int offset, GradeVisitor visit, void* ctx) {
+    int param = sqlite3_bind_parameter_count(stmt);
+    sqlite3_bind_int(stmt, param - 1, limit > 0 ? limit : -1);
+    sqlite3_bind_int(stmt, param, offset > 0 ? offset : 0);
+    
+    int rows = 0;
+    int rc;
+    char uuid[UUID_STR_LEN];
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        struct GradeRow row;
+        const char* cls = (const char*)sqlite3_column_text(stmt, 2);
+        uuidColumn(stmt, 0, uuid);
+        row.uuid = uuid;
+        row.username = (const char*)sqlite3_column_text(stmt, 1);
+        row.class_name = cls ? cls : "";
+        row.student_num = sqlite3_column_int(stmt, 3);
+        row.total_score = sqlite3_column_int(stmt, 4);
+        row.total_questions = sqlite3_column_int(stmt, 5);
+        row.accuracy = sqlite3_column_double(stmt, 6);
+        
+        rows++;
+        int stop = visit(&row, ctx);
+        if (stop < 0) rows = -1;
+        if (stop != 0) break;
     }
     
-    // u - users; ar - arswer_records
-    const char* sql = "SELECT u.uuid, u.username, u.class_name, u.student_num, SUM(ar.score), COUNT(ar.aid), CAST(SUM(ar.is_correct) AS FLOAT) / COUNT(ar.aid) FROM users u LEFT JOIN answer_records ar ON u.uuid = ar.student_uuid WHERE u.class_name = ? AND u.user_level = 2 GROUP BY u.uuid ORDER BY SUM(ar.score) DESC";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
-        *count = 0;
-        return NULL;
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Query grades failed: %s\n", sqlite3_errmsg(sqlite3_db_handle(stmt)));
+        rows = -1;
     }
+    stmtRelease(stmt);
+    return rows;
+}
+
+/**
+ * @brief 按姓名（模糊匹配）遍历成绩
+ * @param limit 最多返回的行数，<= 0 表示不限
+ * @param offset 跳过的行数
+ * @return 回调处理的行数，失败返回 -1
+ */
+int forEachGradeByName(const char* username, int limit, int offset, GradeVisitor visit, void* ctx) {
+    return forEachGradeByNameMatch(username, NAME_MATCH_SUBSTRING, limit, offset, visit, ctx);
+}
+
+/**
+ * @brief 按姓名遍历成绩，match 指定包含、开头或完全相同
+ * 包含查询先在 username_grams 中取出含有关键字 n-gram 的用户，只读取这些用户的成绩；
+ * 关键字不足两个字节时没有可用的 n-gram，退回扫描 users。包含查询按字节比较，_ 与 % 没有特殊含义
+ * @return 回调处理的行数，失败返回 -1
+ */
+int forEachGradeByNameMatch(const char* username, enum NameMatch match, int limit, int offset, GradeVisitor visit, void* ctx) {
+    enum StmtId id = match == NAME_MATCH_EXACT ? STMT_GRADES_BY_NAME_EXACT
+                   : match == NAME_MATCH_PREFIX ? STMT_GRADES_BY_NAME_PREFIX
+                   : strlen(username) >= 2 ? STMT_GRADES_BY_NAME_GRAMS : STMT_GRADES_BY_NAME;
+    sqlite3_stmt* stmt = stmtGet(id);
+    if (!stmt) return -1;
+    
+    if (match == NAME_MATCH_SUBSTRING) {
+        /* 与 SQLite 的 lower() 相同，只转换 ASCII 字母 */
+        char key[100];
+        size_t len = strlen(username);
+        if (len > sizeof(key)) len = sizeof(key);
+        for (size_t i = 0; i < len; i++) {
+            unsigned char c = (unsigned char)username[i];
+            key[i] = (char)(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        }
+        sqlite3_bind_blob(stmt, 1, key, (int)len, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
+    }
+    return visit_grades(stmt, limit, offset, visit, ctx);
+}
+
+/**
+ * @brief 按班级遍历成绩（总分降序）
+ */
+int forEachGradeByClass(const char* class_name, int limit, int offset, GradeVisitor visit, void* ctx) {
+    sqlite3_stmt* stmt = stmtGet(STMT_GRADES_BY_CLASS);
+    if (!stmt) return -1;
     
     sqlite3_bind_text(stmt, 1, class_name, -1, SQLITE_STATIC);
+    return visit_grades(stmt, limit, offset, visit, ctx);
+}
+
+/**
+ * @brief 按学号范围遍历成绩（学号升序）
+ */
+int forEachGradeByStudentNumRange(int min_num, int max_num, int limit, int offset, GradeVisitor visit, void* ctx) {
+    sqlite3_stmt* stmt = stmtGet(STMT_GRADES_BY_NUM_RANGE);
+    if (!stmt) return -1;
     
-    int capacity = 20;
-    struct GradeInfo* grades = (struct GradeInfo*)malloc(sizeof(struct GradeInfo) * capacity);
-    *count = 0;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        if (*count >= capacity) {
-            capacity *= 2;
-            grades = (struct GradeInfo*)realloc(grades, sizeof(struct GradeInfo) * capacity);
-        }
-        
-        strncpy(grades[*count].uuid, (const char*)sqlite3_column_text(stmt, 0), 36);
-        strncpy(grades[*count].username, (const char*)sqlite3_column_text(stmt, 1), 99);
-        strncpy(grades[*count].class_name, (const char*)sqlite3_column_text(stmt, 2), 49);
-        grades[*count].student_num = sqlite3_column_int(stmt, 3);
-        grades[*count].total_score = sqlite3_column_int(stmt, 4);
-        grades[*count].total_questions = sqlite3_column_int(stmt, 5);
-        grades[*count].accuracy = sqlite3_column_double(stmt, 6);
-        
-        (*count)++;
+    sqlite3_bind_int(stmt, 1, min_num);
+    sqlite3_bind_int(stmt, 2, max_num);
+    return visit_grades(stmt, limit, offset, visit, ctx);
+}
+
+/* 将遍历结果收集为 GradeInfo 数组，供旧接口使用 */
+struct GradeArray {
+    struct GradeInfo* items;
+    int count;
+    int capacity;
+};
+
+static void copy_field(char* dst, size_t size, const char* src) {
+    strncpy(dst, src ? src : "", size - 1);
+    dst[size - 1] = '\0';
+}
+
+static int collect_grade(const struct GradeRow* row, void* ctx) {
+    struct GradeArray* arr = (struct GradeArray*)ctx;
+    if (arr->count >= arr->capacity) {
+        int capacity = arr->capacity ? arr->capacity * 2 : 16;
+        struct GradeInfo* items = (struct GradeInfo*)realloc(arr->items, sizeof(struct GradeInfo) * capacity);
+        if (!items) return -1;
+        arr->items = items;
+        arr->capacity = capacity;
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return grades;
+    struct GradeInfo* g = &arr->items[arr->count++];
+    copy_field(g->uuid, sizeof(g->uuid), row->uuid);
+    copy_field(g->username, sizeof(g->username), row->username);
+    copy_field(g->class_name, sizeof(g->class_name), row->class_name);
+    g->student_num = row->student_num;
+    g->total_score = row->total_score;
+    g->total_questions = row->total_questions;
+    g->accuracy = row->accuracy;
+    return 0;
 }
 
 /**
- * @brief 按学生学号返回获取成绩
+ * @brief 按姓名获取成绩
  */
-struct GradeInfo* getGradesByStudentNumRange(int min_num, int max_num, int* count) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+struct GradeInfo* getGradesByName(const char* username, int* count) {
+    return getGradesByNameMatch(username, NAME_MATCH_SUBSTRING, count);
+}
+
+/**
+ * @brief 按姓名与匹配方式获取成绩
+ */
+struct GradeInfo* getGradesByNameMatch(const char* username, enum NameMatch match, int* count) {
+    struct GradeArray arr = {NULL, 0, 0};
+    if (forEachGradeByNameMatch(username, match, 0, 0, collect_grade, &arr) < 0) {
+        free(arr.items);
         *count = 0;
         return NULL;
     }
-    
-    const char* sql = "SELECT u.uuid, u.username, u.class_name, u.student_num, SUM(ar.score), COUNT(ar.aid), CAST(SUM(ar.is_correct) AS FLOAT) / COUNT(ar.aid) FROM users u LEFT JOIN answer_records ar ON u.uuid = ar.student_uuid WHERE u.student_num >= ? AND u.student_num <= ? AND u.user_level = 2 GROUP BY u.uuid ORDER BY u.student_num ASC";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
+    *count = arr.count;
+    return arr.items;
+}
+
+/**
+ * @brief 按班级获取成绩
+ */
+struct GradeInfo* getGradesByClass(const char* class_name, int* count) {
+    struct GradeArray arr = {NULL, 0, 0};
+    if (forEachGradeByClass(class_name, 0, 0, collect_grade, &arr) < 0) {
+        free(arr.items);
         *count = 0;
         return NULL;
     }
-    
-    sqlite3_bind_int(stmt, 1, min_num);
-    sqlite3_bind_int(stmt, 2, max_num);
-    
-    int capacity = 20;
-    struct GradeInfo* grades = (struct GradeInfo*)malloc(sizeof(struct GradeInfo) * capacity);
-    *count = 0;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        if (*count >= capacity) {
-            capacity *= 2;
-            grades = (struct GradeInfo*)realloc(grades, sizeof(struct GradeInfo) * capacity);
-        }
-        
-        strncpy(grades[*count].uuid, (const char*)sqlite3_column_text(stmt, 0), 36);
-        strncpy(grades[*count].username, (const char*)sqlite3_column_text(stmt, 1), 99);
-        strncpy(grades[*count].class_name, (const char*)sqlite3_column_text(stmt, 2), 49);
-        grades[*count].student_num = sqlite3_column_int(stmt, 3);
-        grades[*count].total_score = sqlite3_column_int(stmt, 4);
-        grades[*count].total_questions = sqlite3_column_int(stmt, 5);
-        grades[*count].accuracy = sqlite3_column_double(stmt, 6);
-        
-        (*count)++;
+    *count = arr.count;
+    return arr.items;
+}
+
+/**
+ * @brief 按学生学号返回获取成绩
+ */
+struct GradeInfo* getGradesByStudentNumRange(int min_num, int max_num, int* count) {
+    struct GradeArray arr = {NULL, 0, 0};
+    if (forEachGradeByStudentNumRange(min_num, max_num, 0, 0, collect_grade, &arr) < 0) {
+        free(arr.items);
+        *count = 0;
+        return NULL;
     }
-    
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return grades;
+    *count = arr.count;
+    return arr.items;
+}
+
+/* 分数段统计 */
+struct ScoreBuckets {
+    int count_90, count_80, count_70, count_60, count_other;
+    int total_students;
+};
+
+static int print_and_count(const struct GradeRow* row, void* ctx) {
+    struct ScoreBuckets* b = (struct ScoreBuckets*)ctx;
+    int score = row->total_score;
+    
+    // 固定输出间距 20 15 10 10
+    printf("%-20s %-15s %-10d %-10d\n", row->username, row->class_name, row->student_num, score);
+    
+    b->total_students++;
+    if (score >= 90) b->count_90++;
+    else if (score >= 80) b->count_80++;
+    else if (score >= 70) b->count_70++;
+    else if (score >= 60) b->count_60++;
+    else b->count_other++;
+    return 0;
 }
 
 /**
@@ -647,84 +1022,119 @@ struct GradeInfo* getGradesByStudentNumRange(int min_num, int max_num, int* coun
  * @param class_name 
  */
 void statisticsByClass(const char* class_name) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
-        fprintf(stderr, "[ERROR] Cannot open database\n");
-        return;
-    }
-    
-    // 统计特定班级中所有学生的成绩，并计算出正确率
-    // 按总得分降序排序
-    const char* sql = "SELECT u.uuid, u.username, u.class_name, u.student_num, SUM(ar.score), COUNT(ar.aid), CAST(SUM(ar.is_correct) AS FLOAT) / COUNT(ar.aid) FROM users u LEFT JOIN answer_records ar ON u.uuid = ar.student_uuid WHERE u.class_name = ? AND u.user_level = 2 GROUP BY u.uuid ORDER BY SUM(ar.score) DESC";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "[ERROR] Prepare SQL failed\n");
-        sqlite3_close(db);
-        return;
-    }
-    
-    sqlite3_bind_text(stmt, 1, class_name, -1, SQLITE_STATIC);
-    
-    int count_90 = 0, count_80 = 0, count_70 = 0, count_60 = 0, count_other = 0;
-    int total_students = 0;
+    struct ScoreBuckets b = {0, 0, 0, 0, 0, 0};
     
     printf("\n=== Grade Statistics for Class: %s ===\n", class_name);
     printf("%-20s %-15s %-10s %-10s\n", "姓名", "班级", "学号", "分数");
     printf("%-20s %-15s %-10s %-10s\n", "--------------------", "---------------", "----------", "----------");
     
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        const char* username = (const char*)sqlite3_column_text(stmt, 1);
-        const char* cls = (const char*)sqlite3_column_text(stmt, 2);
-        int num = sqlite3_column_int(stmt, 3);
-        int score = sqlite3_column_int(stmt, 4);
-        
-        // 固定输出间距 20 15 10 10
-        printf("%-20s %-15s %-10d %-10d\n", username, cls, num, score);
-        
-        total_students++;
-        if (score >= 90) count_90++;
-        else if (score >= 80) count_80++;
-        else if (score >= 70) count_70++;
-        else if (score >= 60) count_60++;
-        else count_other++;
+    // 统计特定班级中所有学生的成绩，按总得分降序逐行输出
+    if (forEachGradeByClass(class_name, 0, 0, print_and_count, &b) < 0) {
+        fprintf(stderr, "[ERROR] Cannot open database\n");
+        return;
     }
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    
     printf("\n=== 分数统计 ===\n");
-    printf("90-100: %d students\n", count_90);
-    printf("80-89:  %d students\n", count_80);
-    printf("70-79:  %d students\n", count_70);
-    printf("60-69:  %d students\n", count_60);
-    printf("<60:    %d students\n", count_other);
-    printf("Total:  %d students\n", total_students);
+    printf("90-100: %d students\n", b.count_90);
+    printf("80-89:  %d students\n", b.count_80);
+    printf("70-79:  %d students\n", b.count_70);
+    printf("60-69:  %d students\n", b.count_60);
+    printf("<60:    %d students\n", b.count_other);
+    printf("Total:  %d students\n", b.total_students);
 }
 
 /**
- * @brief 开始答题
+ * @brief 根据 answer_records 重新计算 student_stats
+ * 平时由触发器增量维护，仅在汇总表与答题记录不一致时使用
+ * @return 若重建成功，返回 1
  */
-int startQuiz(const char* student_uuid, const char* student_name, const char* class_name, int student_num) {
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
-        fprintf(stderr, "[ERROR] Cannot open database\n");
+int rebuildStudentStats(void) {
+    if (!flushAnswerSession() || !dbBegin()) return 0;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_STATS_CLEAR);
+    int ok = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+    stmtRelease(stmt);
+    if (ok) {
+        stmt = stmtGet(STMT_STATS_REBUILD);
+        ok = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+        stmtRelease(stmt);
+    }
+    
+    if (!ok || !dbCommit()) {
+        fprintf(stderr, "[ERROR] Rebuild student stats failed: %s\n", sqlite3_errmsg(dbGet()));
+        dbRollback();
         return 0;
     }
+    printf("[SUCCESS] Student stats rebuilt\n");
+    return 1;
+}
+
+/**
+ * @brief 按答题记录的答错率批量重新计算题目难度
+ * @param min_answers 答题次数少于该值的题目保持原难度
+ * @return 难度发生变化的题目数，失败返回 -1
+ */
+int recomputeDifficulty(int min_answers) {
+    if (!flushAnswerSession() || !dbBegin()) return -1;
+    
+    int changed = 0;
+    sqlite3_stmt* stmt = stmtGet(STMT_DIFFICULTY_UPDATE);
+    int ok = stmt != NULL;
+    if (ok) {
+        sqlite3_bind_int(stmt, 1, min_answers > 0 ? min_answers : 1);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        changed = sqlite3_changes(dbGet());
+    }
+    stmtRelease(stmt);
     
-    int count = 0;
-    struct Question* questions = getQuestions(&count);
-    if (!questions || count == 0) {
+    if (!ok || !dbCommit()) {
+        fprintf(stderr, "[ERROR] Recompute difficulty failed: %s\n", sqlite3_errmsg(dbGet()));
+        dbRollback();
+        return -1;
+    }
+    printf("[SUCCESS] Difficulty recomputed, %d questions changed\n", changed);
+    return changed;
+}
+
+/**
+ * @brief 开始答题，使用缺省选项（随机抽取 QUIZ_DEFAULT_SIZE 道题）
+ */
+int startQuiz(const char* student_uuid, const char* student_name, const char* class_name, int student_num) {
+    return startQuizWithOptions(student_uuid, student_name, class_name, student_num, NULL);
+}
+
+/**
+ * @brief 开始答题：按 options 从题库中随机抽题，只读取被抽中的题目
+ * @param options 题目数量与抽题方式，NULL 时使用缺省选项
+ */
+int startQuizWithOptions(const char* student_uuid, const char* student_name, const char* class_name, int student_num,
+                         const struct QuizOptions* options) {
+    int size = options && options->size > 0 ? options->size : QUIZ_DEFAULT_SIZE;
+    enum QuizSampling sampling = options ? options->sampling : QUIZ_SAMPLE_UNIFORM;
+    
+    struct QuestionSet sampled;
+    questionSetInit(&sampled);
+    const struct QuestionSet* questions = &sampled;
+    int due = 0;
+    if (sampling == QUIZ_SAMPLE_REVIEW) {
+        /* 查询失败时仍可用均匀抽取的题目完成测验 */
+        reviewDueQuestions(student_uuid, (long long)time(NULL), size, &sampled);
+        due = sampled.count;
+    }
+    int sampled_ok = sampling == QUIZ_SAMPLE_MIX ? sampleByDifficultyMix(options->mix, size, &sampled) >= 0
+                                                 : sampleQuestions(size - due, sampling, &sampled) >= 0;
+    if (!sampled_ok || sampled.count == 0) {
         printf("[ERROR] No questions available\n");
-        sqlite3_close(db);
+        questionSetFree(&sampled);
         return 0;
     }
+    int count = questions->count;
     
     int points_per_question = 100 / count;
     int total_score = 0;
     int correct_count = 0;
+    struct GradePolicy policy;
+    gradeDefaultPolicy(&policy);
 
     /* 为记录学生答案准备临时数组 */
     char **q_words = (char**)malloc(sizeof(char*) * count);
@@ -735,15 +1145,22 @@ int startQuiz(const char* student_uuid, const char* student_name, const char* cl
     printf("\n====== Quiz: Vocabulary Scale ======\n");
     printf("考生信息: %s (班级: %s, 学号: %d)\n", student_name, class_name, student_num);
     printf("题目数量: %d, 每题分数: %d\n", count, points_per_question);
+    if (sampling == QUIZ_SAMPLE_REVIEW) printf("其中到期复习: %d\n", due);
     printf("======================================\n\n");
     
+    /* 答题记录先缓存在内存中，测验结束时一次性提交 */
+    beginAnswerSession();
     for (int i = 0; i < count; i++) {
+        if (answerSessionSignal()) {
+            count = i;
+            break;
+        }
         printf("[Question %d/%d]\n", i + 1, count);
         /* 生成并显示 word_puzzled，并显示翻译，要求输入正确的英文单词 */
         char puzzled[MAX_WORD_LENGTH];
-        make_puzzled(questions[i].word, puzzled, sizeof(puzzled));
+        questionSetPuzzle(questions, i, puzzled, sizeof(puzzled));
         printf("No. %d: %s\n", i, puzzled);
-        printf("Translation: %s\n", questions[i].translate);
+        printf("Translation: %s\n", questionSetTranslate(questions, i));
         printf("Your answer: ");
 
         char user_answer[MAX_TRANS_LENGTH];
@@ -751,30 +1168,47 @@ int startQuiz(const char* student_uuid, const char* student_name, const char* cl
             user_answer[0] = '\0';
         }
         user_answer[strcspn(user_answer, "\r\n")] = 0;
+        /* 被信号打断的这一题不计分，已答的题目在结束会话时提交 */
+        if (answerSessionSignal()) {
+            count = i;
+            break;
+        }
 
-        int is_correct = (strcmp(user_answer, questions[i].word) == 0) ? 1 : 0;
-        int score = is_correct ? points_per_question : 0;
+        /* 大小写、空白不同或只差一处拼写时给部分分，只有满分才记为答对 */
+        struct GradeResult grade = gradeAnswer(user_answer, questionSetWord(questions, i), &policy);
+        int is_correct = grade.credit >= 100;
+        int score = points_per_question * grade.credit / 100;
         total_score += score;
         if (is_correct) correct_count++;
         
-    saveAnswerRecord(student_uuid, questions[i].qid, user_answer, is_correct, score);
+    saveAnswerRecord(student_uuid, questions->qids[i], user_answer, is_correct, score);
     /* 保存到临时数组，供导出使用（复制字符串） */
-    q_words[i] = strdup(questions[i].translate); // question_words
+    q_words[i] = strdup(questionSetTranslate(questions, i)); // question_words
     u_answers[i] = strdup(user_answer); // user_answers
-    c_answers[i] = strdup(questions[i].word); // correct_answers
+    c_answers[i] = strdup(questionSetWord(questions, i)); // correct_answers
         
         /* 保存答题详情到 stu.txt（每题的学生答案和正确答案） */
         /* 这里只临时收集问题、学生答案和正确答案到数组，最后一次性写入文件 */
         /* 将在循环外统一处理 */
         
-        printf(">> 正确答案: %s [%s]\n\n", questions[i].word, is_correct ? "CORRECT" : "WRONG");
+        if (is_correct || score == 0) {
+            printf(">> 正确答案: %s [%s]\n\n", questionSetWord(questions, i), is_correct ? "CORRECT" : "WRONG");
+        } else {
+            printf(">> 正确答案: %s [PARTIAL %d/%d]\n\n", questionSetWord(questions, i), score, points_per_question);
+        }
     }
     
+    if (!endAnswerSession()) {
+        fprintf(stderr, "[ERROR] Save answers failed\n");
+    }
+    int interrupted = answerSessionSignal();
+    if (interrupted) printf("\n[INFO] 测验被中断，已保存前 %d 题的答案\n", count);
+    
     printf("\n====== 测试结果 ======\n");
     printf("考生: %s\n", student_name);
     printf("正确数: %d / %d\n", correct_count, count);
     printf("总分: %d / 100\n", total_score);
-    printf("正确率: %.2f%%\n", (correct_count * 100.0) / count);
+    printf("正确率: %.2f%%\n", count > 0 ? (correct_count * 100.0) / count : 0.0);
     printf("========================\n\n");
     
     /* 将答题明细追加到 stu.txt（调用 file_io） */
@@ -790,8 +1224,12 @@ int startQuiz(const char* student_uuid, const char* student_name, const char* cl
         if (c_answers[i]) free(c_answers[i]);
     }
     free(q_words); free(u_answers); free(c_answers);
-    free(questions);
-    sqlite3_close(db);
+    questionSetFree(&sampled);
+    /* 答案已提交、原来的信号处理方式已恢复，按原信号结束进程 */
+    if (interrupted) {
+        fflush(stdout);
+        raise(interrupted);
+    }
     return total_score;
 }
 
@@ -8,6 +8,9 @@
 #define MAX_TRANS_LENGTH 200
 #define DB_NAME "vocab_system.db"
 
+/* 测验期间缓存的答题记录条数上限，攒满后在一个事务内批量提交 */
+#define ANSWER_BATCH_SIZE 32
+
 /* 题目 */
 struct Question {
     int qid;
@@ -27,26 +30,116 @@ struct GradeInfo {
     double accuracy;
 };
 
+/* 成绩遍历时逐行传给回调的数据，字符串指针仅在回调期间有效 */
+struct GradeRow {
+    const char* uuid;
+    const char* username;
+    const char* class_name;
+    int student_num;
+    int total_score;
+    int total_questions;
+    double accuracy;
+};
+
+/* 成绩回调，返回非 0 时停止遍历；返回负数表示出错，遍历函数随之返回 -1 */
+typedef int (*GradeVisitor)(const struct GradeRow* row, void* ctx);
+
+/* 按姓名查询成绩时的匹配方式 */
+enum NameMatch {
+    NAME_MATCH_SUBSTRING,   /* 姓名包含关键字（按字节，_ 与 % 不是通配符），ASCII 字母不区分大小写；关键字至少两个字节时走 username_grams */
+    NAME_MATCH_PREFIX,      /* 姓名以关键字开头（区分大小写），按用户名索引范围查找 */
+    NAME_MATCH_EXACT        /* 姓名与关键字完全相同 */
+};
+
+/* 登录时一次查出的用户资料，由调用方在会话期间缓存 */
+struct UserProfile {
+    char uuid[37];
+    char username[100];
+    int level;              /* 0=Admin 1=Teacher 2=Student */
+    char class_name[50];
+    int student_num;
+    char teacher_uuid[37];  /* 没有任课教师时为空串 */
+};
+
 /* 用户管理函数 */
 char* createUser(const char* username, const char* password, int user_level, 
                  const char* class_name, int student_num, const char* teacher_uuid);
+int loginUserProfile(const char* username, const char* password, struct UserProfile* profile);
+
+/* 批量创建用户时每行的结果 */
+enum RosterStatus {
+    ROSTER_OK,          /* 已创建 */
+    ROSTER_INVALID,     /* 缺少用户名或密码、等级不是 2（名单只能建立学生）、教师 UUID 格式错误 */
+    ROSTER_DUPLICATE,   /* 用户名已存在（库中或名单前面的行） */
+    ROSTER_FAILED       /* 数据库错误，整个名单已回滚 */
+};
+
+/* 名单中的一行：前六项由调用方填写，uuid 与 status 由 createUsersBulk 填写 */
+struct RosterEntry {
+    const char* username;
+    const char* password;
+    int level;
+    const char* class_name;
+    int student_num;
+    const char* teacher_uuid;   /* 可为 NULL 或空串 */
+    char uuid[37];              /* 新用户的 UUID，未创建时为空串 */
+    enum RosterStatus status;
+};
+
+/* 在一个事务内创建名单中的所有学生，返回创建的用户数，失败返回 -1 且合法的行为 ROSTER_FAILED */
+int createUsersBulk(struct RosterEntry* entries, int count);
 char* loginUser(const char* username, const char* password);
 int getUserLevel(const char* uuid);
 int deleteUser(const char* uuid);
+/* 在一个事务内删除一批学生（user_level = 2）及其答题数据并归还空闲页，返回删除的学生数，失败返回 -1 */
+int deleteUsersByClass(const char* class_name);
+int deleteUsersByStudentNumRange(int min_num, int max_num);
+
+/* 批量导入题目时每个事务包含的行数 */
+#define IMPORT_CHUNK_ROWS 5000
+
+/* 批量导入的结果统计 */
+struct ImportStats {
+    int inserted;   /* 新增的题目 */
+    int updated;    /* 单词已存在、翻译被更新的题目 */
+    int skipped;    /* 与库中相同、格式错误或注释行 */
+};
 
 /* 题目管理函数 */
 int addSingleQuestion(const char* word, const char* translate);
 int addQuestion(const char* source);
+int importQuestionsBulk(const char* source, struct ImportStats* stats);
 int deleteSingleQuestion(int qid);
 struct Question* getQuestions(int* count);
 
 /* 回答问题的相关函数 */
 int saveAnswerRecord(const char* student_uuid, int qid, const char* user_answer, int is_correct, int score);
+int forEachGradeByName(const char* username, int limit, int offset, GradeVisitor visit, void* ctx);
+int forEachGradeByNameMatch(const char* username, enum NameMatch match, int limit, int offset, GradeVisitor visit, void* ctx);
+int forEachGradeByClass(const char* class_name, int limit, int offset, GradeVisitor visit, void* ctx);
+int forEachGradeByStudentNumRange(int min_num, int max_num, int limit, int offset, GradeVisitor visit, void* ctx);
 struct GradeInfo* getGradesByName(const char* username, int* count);
+struct GradeInfo* getGradesByNameMatch(const char* username, enum NameMatch match, int* count);
 struct GradeInfo* getGradesByClass(const char* class_name, int* count);
 struct GradeInfo* getGradesByStudentNumRange(int min_num, int max_num, int* count);
 void statisticsByClass(const char* class_name);
+int rebuildStudentStats(void);
+/* 按答错率重新计算题目难度（1 到 DIFFICULTY_LEVELS），返回难度变化的题目数，失败返回 -1 */
+int recomputeDifficulty(int min_answers);
+/*
+ * 答题会话：beginAnswerSession 之后 saveAnswerRecord 只写入内存缓冲，
+ * 缓冲满 ANSWER_BATCH_SIZE 条、调用 flush/end 或进程异常退出时在一个事务内提交
+ */
+void beginAnswerSession(void);
+int flushAnswerSession(void);
+int endAnswerSession(void);
+/* 会话期间收到 SIGINT / SIGTERM 时返回信号编号（处理函数只记录信号），调用方应停止答题并 endAnswerSession */
+int answerSessionSignal(void);
 int startQuiz(const char* student_uuid, const char* student_name, const char* class_name, int student_num);
+/* 测验选项（题目数量、抽题方式）定义在 quiz_sample.h */
+struct QuizOptions;
+int startQuizWithOptions(const char* student_uuid, const char* student_name, const char* class_name, int student_num,
+                         const struct QuizOptions* options);
 
 /* 内存管理 */
 void freeGrades(struct GradeInfo* grades);
@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <iconv.h>
+#endif
+#include "dict.h"
+#include "connection.h"
+#include "question_cache.h"
+
+/* 直接查询模式下的只读连接及其语句，首次使用时准备 */
+static sqlite3* dict_db = NULL;
+static sqlite3_stmt* foreach_stmt = NULL;
+static sqlite3_stmt* lookup_stmt = NULL;
+
+/*
+ * 筛选条件，参数：?1 词性  ?2 最短长度  ?3 最长长度  ?4 仅小写  ?5 LIMIT
+ * 词性标记出现在释义开头或紧跟在非字母之后（如 "v.获取n.接近" 中的 "n."、"n&v." 中的 "v."）
+ * 词库中有重复的单词，按单词分组后保持词库原有顺序
+ */
+#define DICT_FILTER_SQL(table) \
+    " FROM " table " WHERE word IS NOT NULL AND translate IS NOT NULL" \
+    " AND (?1 IS NULL OR translate GLOB ?1 || '*' OR translate GLOB '*[^a-z]' || ?1 || '*')" \
+    " AND length(word) >= ?2 AND (?3 <= 0 OR length(word) <= ?3)" \
+    " AND (?4 = 0 OR word = lower(word))" \
+    " GROUP BY word ORDER BY min(rowid) LIMIT ?5"
+
+/* 词库的释义是 UTF-8，查询与导入时经 SQL 函数 gbk() 转换为题库与控制台使用的 GBK */
+#define DICT_TRANSLATE_SQL "gbk(translate)"
+
+#ifdef _WIN32
+/**
+ * @brief 把 UTF-8 文本转换为 GBK（代码页 936），无法表示的字符由系统替换为 '?'
+ * @return malloc 分配、以 '\0' 结尾的结果，长度写入 out_len；内存不足返回 NULL
+ */
+static char* utf8_to_gbk(const char* s, int len, int* out_len) {
+    int wide_len = MultiByteToWideChar(CP_UTF8, 0, s, len, NULL, 0);
+    wchar_t* wide = (wchar_t*)malloc(sizeof(wchar_t) * (wide_len > 0 ? wide_len : 1));
+    if (!wide) return NULL;
+    MultiByteToWideChar(CP_UTF8, 0, s, len, wide, wide_len);
+    int n = WideCharToMultiByte(936, 0, wide, wide_len, NULL, 0, NULL, NULL);
+    char* out = (char*)malloc(n + 1);
+    if (out) {
+        WideCharToMultiByte(936, 0, wide, wide_len, out, n, NULL, NULL);
+        out[n] = '\0';
+        *out_len = n;
+    }
+    free(wide);
+    return out;
+}
+#else
+/**
+ * @brief 把 UTF-8 文本转换为 GBK，无法表示或不合法的字符替换为 '?'
+ * GBK 中每个字符都不长于它的 UTF-8 编码，结果不超过 len 字节
+ * @return malloc 分配、以 '\0' 结尾的结果，长度写入 out_len；内存不足或没有 GBK 转换器时返回 NULL
+ */
+static char* utf8_to_gbk(const char* s, int len, int* out_len) {
+    static iconv_t cd = (iconv_t)-1;
+    if (cd == (iconv_t)-1 && (cd = iconv_open("GBK", "UTF-8")) == (iconv_t)-1) return NULL;
+    char* out = (char*)malloc(len + 1);
+    if (!out) return NULL;
+    char* in = (char*)s;
+    size_t in_left = len;
+    char* p = out;
+    size_t out_left = len;
+    iconv(cd, NULL, NULL, NULL, NULL);
+    while (in_left > 0 && iconv(cd, &in, &in_left, &p, &out_left) == (size_t)-1) {
+        if (errno == E2BIG || out_left == 0) break;
+        /* 跳过无法转换的字符（首字节与之后的续字节） */
+        *p++ = '?';
+        out_left--;
+        do {
+            in++;
+            in_left--;
+        } while (in_left > 0 && ((unsigned char)*in & 0xC0) == 0x80);
+    }
+    *p = '\0';
+    *out_len = (int)(p - out);
+    return out;
+}
+#endif
+
+/**
+ * @brief SQL 函数 gbk(text)：把词库中的 UTF-8 文本转换为 GBK，NULL 保持为 NULL
+ */
+static void gbk_function(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    (void)argc;
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) return;
+    const char* text = (const char*)sqlite3_value_text(argv[0]);
+    int len = sqlite3_value_bytes(argv[0]);
+    int out_len = 0;
+    char* out = text ? utf8_to_gbk(text, len, &out_len) : NULL;
+    if (!out) {
+        sqlite3_result_error(ctx, "cannot convert dictionary text from UTF-8 to GBK", -1);
+        return;
+    }
+    sqlite3_result_text(ctx, out, out_len, free);
+}
+
+/**
+ * @brief 在连接上注册 gbk() 函数
+ */
+static int register_gbk(sqlite3* db) {
+    return sqlite3_create_function(db, "gbk", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
+                                   gbk_function, NULL, NULL) == SQLITE_OK;
+}
+
+/**
+ * @brief 绑定筛选条件，filter 为 NULL 表示不限
+ */
+static void bind_filter(sqlite3_stmt* stmt, const struct DictFilter* filter) {
+    struct DictFilter none = {NULL, 0, 0, 0, 0};
+    if (!filter) filter = &none;
+    if (filter->pos && filter->pos[0]) {
+        sqlite3_bind_text(stmt, 1, filter->pos, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 1);
+    }
+    sqlite3_bind_int(stmt, 2, filter->min_len);
+    sqlite3_bind_int(stmt, 3, filter->max_len);
+    sqlite3_bind_int(stmt, 4, filter->lowercase_only);
+    sqlite3_bind_int(stmt, 5, filter->limit > 0 ? filter->limit : -1);
+}
+
+/**
+ * @brief 生成只读、immutable 的 URI 文件名，对 URI 中有特殊含义的字符转义
+ * immutable 告诉 SQLite 文件不会被修改，从而跳过加锁与变更检查
+ */
+static void make_dict_uri(const char* path, char* uri, size_t size) {
+    size_t n = 0;
+    n += snprintf(uri, size, "file:");
+    for (const char* p = path; *p && n + 4 < size; p++) {
+        if (*p == '%' || *p == '?' || *p == '#') {
+            n += snprintf(uri + n, size - n, "%%%02X", (unsigned char)*p);
+        } else {
+            uri[n++] = *p;
+        }
+    }
+    uri[n] = '\0';
+    snprintf(uri + n, size - n, "?mode=ro&immutable=1");
+}
+
+/**
+ * @brief 在共享连接上执行一条带一个文本参数的语句
+ */
+static int exec_with_text(sqlite3* db, const char* sql, const char* text) {
+    sqlite3_stmt* stmt = NULL;
+    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (rc == SQLITE_OK) {
+        if (text) sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE || rc == SQLITE_ROW;
+}
+
+/**
+ * @brief 从 CET4 词库导入题目
+ * ATTACH 后在一个写事务中执行 INSERT ... SELECT，数据不经过 C 代码逐行绑定，释义由 gbk() 转换为 GBK
+ * 语句只在 dict 附加期间有效，因此不放入语句缓存
+ * @param dict_path 词库文件名（DICT_NAME）
+ * @param filter 筛选条件，可为 NULL
+ * @param stats 输出新增与跳过（题库中已存在）的单词数，可为 NULL
+ * @return 若导入成功，返回 1
+ */
+int importDictQuestions(const char* dict_path, const struct DictFilter* filter, struct ImportStats* stats) {
+    struct ImportStats st = {0, 0, 0};
+    if (stats) *stats = st;
+    
+    sqlite3 *db = dbGet();
+    if (!db) {
+        fprintf(stderr, "[ERROR] Cannot open database\n");
+        return 0;
+    }
+    
+    if (!register_gbk(db)) {
+        fprintf(stderr, "[ERROR] Register gbk() failed: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+    
+    char uri[600];
+    make_dict_uri(dict_path, uri, sizeof(uri));
+    if (!exec_with_text(db, "ATTACH DATABASE ? AS dict", uri)) {
+        fprintf(stderr, "[ERROR] Cannot attach dictionary %s: %s\n", dict_path, sqlite3_errmsg(db));
+        return 0;
+    }
+    
+    sqlite3_stmt* count_stmt = NULL;
+    sqlite3_stmt* insert_stmt = NULL;
+    int ok = 0;
+    if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM (SELECT word" DICT_FILTER_SQL("dict.CET4") ")",
+                           -1, &count_stmt, NULL) != SQLITE_OK
+        || sqlite3_prepare_v2(db, "INSERT INTO questions (word, translate) SELECT word, " DICT_TRANSLATE_SQL
+                              DICT_FILTER_SQL("dict.CET4") " ON CONFLICT(word) DO NOTHING",
+                              -1, &insert_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Prepare dictionary import failed: %s\n", sqlite3_errmsg(db));
+    } else if (dbBegin()) {
+        bind_filter(count_stmt, filter);
+        bind_filter(insert_stmt, filter);
+        int candidates = sqlite3_step(count_stmt) == SQLITE_ROW ? sqlite3_column_int(count_stmt, 0) : 0;
+        if (sqlite3_step(insert_stmt) == SQLITE_DONE) {
+            st.inserted = sqlite3_changes(db);
+            st.skipped = candidates - st.inserted;
+            ok = dbCommit();
+            if (ok) questionCacheInvalidate();
+        } else {
+            fprintf(stderr, "[ERROR] Import dictionary failed: %s\n", sqlite3_errmsg(db));
+        }
+        if (!ok) dbRollback();
+    }
+    sqlite3_finalize(count_stmt);
+    sqlite3_finalize(insert_stmt);
+    exec_with_text(db, "DETACH DATABASE dict", NULL);
+    
+    if (stats) *stats = st;
+    return ok;
+}
+
+/**
+ * @brief 以只读、immutable、mmap 方式打开词库
+ * @return 成功返回 1
+ */
+int dictOpen(const char* dict_path) {
+    if (dict_db) return 1;
+    
+    char uri[600];
+    make_dict_uri(dict_path, uri, sizeof(uri));
+    sqlite3* db = NULL;
+    if (sqlite3_open_v2(uri, &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Cannot open dictionary %s: %s\n", dict_path, db ? sqlite3_errmsg(db) : "out of memory");
+        sqlite3_close(db);
+        return 0;
+    }
+    
+    char sql[64];
+    snprintf(sql, sizeof(sql), "PRAGMA mmap_size = %lld", DICT_MMAP_SIZE);
+    sqlite3_exec(db, sql, NULL, NULL, NULL);
+    
+    /* 打开连接时不会读取文件，这里确认词库表确实存在 */
+    if (!register_gbk(db)
+        || sqlite3_prepare_v3(db, "SELECT word, " DICT_TRANSLATE_SQL DICT_FILTER_SQL("CET4"), -1,
+                           SQLITE_PREPARE_PERSISTENT, &foreach_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Invalid dictionary %s: %s\n", dict_path, sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return 0;
+    }
+    dict_db = db;
+    return 1;
+}
+
+/**
+ * @brief 关闭直接查询模式的连接
+ */
+void dictClose(void) {
+    sqlite3_finalize(foreach_stmt);
+    sqlite3_finalize(lookup_stmt);
+    foreach_stmt = NULL;
+    lookup_stmt = NULL;
+    if (dict_db) {
+        sqlite3_close(dict_db);
+        dict_db = NULL;
+    }
+}
+
+/**
+ * @brief 按条件遍历词库，需先调用 dictOpen
+ * @return 访问的单词数，出错返回 -1
+ */
+int dictForEach(const struct DictFilter* filter, DictVisitor visit, void* ctx) {
+    if (!dict_db) {
+        fprintf(stderr, "[ERROR] Dictionary is not open\n");
+        return -1;
+    }
+    
+    bind_filter(foreach_stmt, filter);
+    int visited = 0;
+    int rc;
+    while ((rc = sqlite3_step(foreach_stmt)) == SQLITE_ROW) {
+        visited++;
+        if (visit((const char*)sqlite3_column_text(foreach_stmt, 0),
+                  (const char*)sqlite3_column_text(foreach_stmt, 1), ctx)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Query dictionary failed: %s\n", sqlite3_errmsg(dict_db));
+        visited = -1;
+    }
+    sqlite3_reset(foreach_stmt);
+    sqlite3_clear_bindings(foreach_stmt);
+    return visited;
+}
+
+/**
+ * @brief 查询单词的释义，需先调用 dictOpen
+ * 词库只读且没有索引，每次查询扫描整张表；词库已整个映射到内存，开销在毫秒以内
+ * @param word 英文单词
+ * @param translate 输出释义
+ * @param size translate 缓冲区大小
+ * @return 找到且有释义返回 1，否则返回 0
+ */
+int dictLookup(const char* word, char* translate, int size) {
+    if (!dict_db) {
+        fprintf(stderr, "[ERROR] Dictionary is not open\n");
+        return 0;
+    }
+    /* 与 DICT_FILTER_SQL 相同，没有释义的词条视为不存在 */
+    if (!lookup_stmt && sqlite3_prepare_v3(dict_db,
+                                           "SELECT " DICT_TRANSLATE_SQL " FROM CET4 WHERE word = ? AND translate IS NOT NULL LIMIT 1",
+                                           -1, SQLITE_PREPARE_PERSISTENT, &lookup_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Query dictionary failed: %s\n", sqlite3_errmsg(dict_db));
+        return 0;
+    }
+    
+    int found = 0;
+    sqlite3_bind_text(lookup_stmt, 1, word, -1, SQLITE_STATIC);
+    if (sqlite3_step(lookup_stmt) == SQLITE_ROW) {
+        snprintf(translate, size, "%s", (const char*)sqlite3_column_text(lookup_stmt, 0));
+        found = 1;
+    }
+    sqlite3_reset(lookup_stmt);
+    sqlite3_clear_bindings(lookup_stmt);
+    return found;
+}
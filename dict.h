@@ -0,0 +1,50 @@
+#ifndef DICT_H
+#define DICT_H
+
+#include "lib/sqlite3.h"
+#include "database.h"
+
+/* 程序附带的 CET4 词库 */
+#define DICT_NAME "dict.db"
+
+/* 直接查询词库时使用的 mmap 大小（词库约 1 MiB，整个映射） */
+#define DICT_MMAP_SIZE (16LL * 1024 * 1024)
+
+/* 词库筛选条件，各字段为 0 / NULL 时表示不限 */
+struct DictFilter {
+    const char* pos;        /* 词性，如 "n." "v." "adj."，与释义中的词性标记匹配 */
+    int min_len;            /* 单词最短长度 */
+    int max_len;            /* 单词最长长度 */
+    int lowercase_only;     /* 为 1 时排除含大写字母的专有名词（如 January） */
+    int limit;              /* 最多选取的单词数，0 表示不限 */
+};
+
+/* 逐条访问词库单词的回调，返回非 0 时停止遍历 */
+typedef int (*DictVisitor)(const char* word, const char* translate, void* ctx);
+
+/*
+ * 词库中的文本是 UTF-8，本模块返回与导入的释义都已转换为 GBK（与题库、控制台一致），
+ * 无法用 GBK 表示的字符替换为 '?'
+ */
+
+/*
+ * 将 dict_path 以只读方式 ATTACH 到共享连接，在一个事务中用 INSERT ... SELECT 把
+ * 符合条件的单词复制到 questions；题库中已有的单词保持不变，计入 skipped
+ * 成功返回 1
+ */
+int importDictQuestions(const char* dict_path, const struct DictFilter* filter, struct ImportStats* stats);
+
+/*
+ * 直接查询模式：以只读、immutable、mmap 方式单独打开词库，不复制到题库
+ * dictOpen 可重复调用，已打开时直接返回 1
+ */
+int dictOpen(const char* dict_path);
+void dictClose(void);
+
+/* 按条件遍历词库（同一单词只访问一次），返回访问的单词数，出错返回 -1 */
+int dictForEach(const struct DictFilter* filter, DictVisitor visit, void* ctx);
+
+/* 查询单词的释义，找到时写入 translate 并返回 1 */
+int dictLookup(const char* word, char* translate, int size);
+
+#endif /* DICT_H */
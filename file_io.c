@@ -3,6 +3,9 @@
 #include <string.h>
 #include "file_io.h"
 #include "database.h"
+#include "connection.h"
+#include "question_cache.h"
+#include "stmt_cache.h"
 
 /**
  * @brief 将所有题目导出到 timu.txt 文件
@@ -19,10 +22,10 @@ int exportQuestionsToFile(const char* filename) {
         return 0;
     }
     
-    int count = 0;
-    struct Question* questions = getQuestions(&count);
+    const struct QuestionSet* questions = questionCacheGet();
+    int count = questions ? questions->count : 0;
     
-    if (!questions || count == 0) {
+    if (count == 0) {
         fprintf(fp, "暂无题目\n");
         fclose(fp);
         printf("[信息] 题目文件已创建: %s (暂无题目)\n", filename);
@@ -37,11 +40,10 @@ int exportQuestionsToFile(const char* filename) {
 
     /* 写入每道题目为一行："1. word" */
     for (int i = 0; i < count; i++) {
-        fprintf(fp, "%d. %s\n", i + 1, questions[i].word);
+        fprintf(fp, "%d. %s\n", i + 1, questionSetWord(questions, i));
     }
     
     fclose(fp);
-    freeQuestions(questions);
     
     printf("[成功] 题目已导出到 %s (%d 道题目)\n", filename, count);
     return 1;
@@ -121,18 +123,14 @@ int addStuAnsToFile(const char* filename, const char* student_name,
  */
 static struct GradeInfo** getGradesByAllClasses(int* class_count, int** counts) {
     /* 简化版：先获取所有成绩，然后按班级分组 */
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+    sqlite3 *db = dbGet();
+    if (!db) {
         *class_count = 0;
         return NULL;
     }
     
-    const char* sql_classes = "SELECT DISTINCT class_name FROM users WHERE class_name IS NOT NULL AND class_name != '' ORDER BY class_name";
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql_classes, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        sqlite3_close(db);
+    sqlite3_stmt* stmt = stmtGet(STMT_CLASS_LIST);
+    if (!stmt) {
         *class_count = 0;
         return NULL;
     }
@@ -143,8 +141,7 @@ static struct GradeInfo** getGradesByAllClasses(int* class_count, int** counts)
         strncpy(classes[*class_count], (const char*)sqlite3_column_text(stmt, 0), 49);
         (*class_count)++;
     }
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     
     return NULL;  /* 简化处理，直接在函数内遍历 */
 }
@@ -165,29 +162,16 @@ int exportGradesByScoreToFile(const char* filename) {
     }
     
     /* 从数据库获取所有学生，按成绩排序 */
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+    sqlite3 *db = dbGet();
+    if (!db) {
         fprintf(stderr, "[错误] 无法打开数据库\n");
         fclose(fp);
         return 0;
     }
     
-    const char* sql = "SELECT u.username, u.class_name, u.student_num, "
-                      "COALESCE(SUM(ar.score), 0) as total_score, "
-                      "COALESCE(COUNT(ar.aid), 0) as question_count, "
-                      "COALESCE(CAST(SUM(ar.is_correct) AS FLOAT) / NULLIF(COUNT(ar.aid), 0), 0.0) as accuracy "
-                      "FROM users u "
-                      "LEFT JOIN answer_records ar ON u.uuid = ar.student_uuid "
-                      "WHERE u.user_level = 2 "
-                      "GROUP BY u.uuid "
-                      "ORDER BY total_score DESC, u.student_num ASC";
-    
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = stmtGet(STMT_EXPORT_BY_SCORE);
+    if (!stmt) {
         fprintf(stderr, "[错误] 准备 SQL 语句失败\n");
-        sqlite3_close(db);
         fclose(fp);
         return 0;
     }
@@ -213,8 +197,7 @@ int exportGradesByScoreToFile(const char* filename) {
     
     fprintf(fp, "\n总计: %d 名学生\n", count);
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     fclose(fp);
     
     printf("[成功] 按成绩排序的结果已导出到 %s (%d 名学生)\n", filename, count);
@@ -237,29 +220,16 @@ int exportGradesByClassToFile(const char* filename) {
     }
     
     /* 从数据库获取所有学生，按班级和成绩排序 */
-    sqlite3 *db;
-    int rc = sqlite3_open("vocab_system.db", &db);
-    if (rc) {
+    sqlite3 *db = dbGet();
+    if (!db) {
         fprintf(stderr, "[错误] 无法打开数据库\n");
         fclose(fp);
         return 0;
     }
     
-    const char* sql = "SELECT u.username, u.class_name, u.student_num, "
-                      "COALESCE(SUM(ar.score), 0) as total_score, "
-                      "COALESCE(COUNT(ar.aid), 0) as question_count, "
-                      "COALESCE(CAST(SUM(ar.is_correct) AS FLOAT) / NULLIF(COUNT(ar.aid), 0), 0.0) as accuracy "
-                      "FROM users u "
-                      "LEFT JOIN answer_records ar ON u.uuid = ar.student_uuid "
-                      "WHERE u.user_level = 2 "
-                      "GROUP BY u.uuid "
-                      "ORDER BY u.class_name ASC, total_score DESC";
-    
-    sqlite3_stmt* stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+    sqlite3_stmt* stmt = stmtGet(STMT_EXPORT_BY_CLASS);
+    if (!stmt) {
         fprintf(stderr, "[错误] 准备 SQL 语句失败\n");
-        sqlite3_close(db);
         fclose(fp);
         return 0;
     }
@@ -294,8 +264,7 @@ int exportGradesByClassToFile(const char* filename) {
     
     fprintf(fp, "\n总计: %d 名学生\n", count);
     
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    stmtRelease(stmt);
     fclose(fp);
     
     printf("[成功] 按班级排序的结果已导出到 %s (%d 名学生)\n", filename, count);
@@ -0,0 +1,263 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "grading.h"
+
+/* 位并行算法一次处理的模式长度上限（一个 64 位字） */
+#define WORD_BITS 64
+
+/* 规范化答案时栈上缓冲区的大小，更长的答案在堆上分配 */
+#define NORMALIZE_STACK 256
+
+/* 字符（码点）数组在栈上的容量，更长的字符串在堆上分配 */
+#define SYMBOL_STACK 128
+
+void gradeDefaultPolicy(struct GradePolicy* policy) {
+    policy->ignore_case = 1;
+    policy->ignore_space = 1;
+    policy->normalized_credit = 100;
+    policy->max_typos = 1;
+    policy->min_typo_length = 4;
+    policy->typo_credit = 50;
+}
+
+static int is_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static int is_ascii(const char* s, int len) {
+    for (int i = 0; i < len; i++) {
+        if ((unsigned char)s[i] >= 0x80) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 按 policy 规范化 src（只折叠 ASCII 字母的大小写），写入 dst（容量不小于 strlen(src) + 1）
+ * @return 规范化后的长度
+ */
+static int normalize(const char* src, char* dst, const struct GradePolicy* policy) {
+    int n = 0;
+    int pending_space = 0;
+    for (const unsigned char* p = (const unsigned char*)src; *p; p++) {
+        unsigned char c = *p;
+        if (policy->ignore_space && is_space(c)) {
+            pending_space = n > 0;  /* 丢弃开头的空白，中间的连续空白合并为一个 */
+            continue;
+        }
+        if (pending_space) {
+            dst[n++] = ' ';
+            pending_space = 0;
+        }
+        if (policy->ignore_case && c >= 'A' && c <= 'Z') c = (unsigned char)(c - 'A' + 'a');
+        dst[n++] = (char)c;
+    }
+    dst[n] = '\0';
+    return n;
+}
+
+/* UTF-8 字符数，非法字节各算一个字符 */
+static int char_count(const char* s, int len) {
+    int n = 0;
+    for (int i = 0; i < len; i++) {
+        if (((unsigned char)s[i] & 0xC0) != 0x80) n++;
+    }
+    return n;
+}
+
+/**
+ * @brief 把 UTF-8 解码为码点；非法或截断的字节按单字节处理，映射到码点范围之外以免与合法字符相同
+ * @return 码点个数
+ */
+static int decode_utf8(const char* s, int len, uint32_t* out) {
+    const unsigned char* p = (const unsigned char*)s;
+    int n = 0;
+    for (int i = 0; i < len;) {
+        unsigned char c = p[i];
+        int extra = c < 0x80 ? 0 : (c & 0xE0) == 0xC0 ? 1 : (c & 0xF0) == 0xE0 ? 2 : (c & 0xF8) == 0xF0 ? 3 : -1;
+        uint32_t cp = extra == 0 ? c : extra == 1 ? (c & 0x1Fu) : extra == 2 ? (c & 0x0Fu) : (c & 0x07u);
+        int ok = extra >= 0 && i + extra < len;
+        for (int j = 1; ok && j <= extra; j++) {
+            if ((p[i + j] & 0xC0) != 0x80) ok = 0;
+            else cp = (cp << 6) | (p[i + j] & 0x3Fu);
+        }
+        if (ok) {
+            out[n++] = cp;
+            i += extra + 1;
+        } else {
+            out[n++] = 0x110000u + c;
+            i++;
+        }
+    }
+    return n;
+}
+
+/*
+ * Myers / Hyyro 位并行编辑距离的一列更新：pv、mv 为 D[i][j] - D[i-1][j] 的 +1 / -1 位向量，
+ * eq 为当前文本字符在模式中出现位置的掩码，返回最后一行的变化（+1、-1 或 0）
+ */
+static int myers_step(uint64_t eq, uint64_t* pv, uint64_t* mv, uint64_t high) {
+    uint64_t xv = eq | *mv;
+    uint64_t xh = (((eq & *pv) + *pv) ^ *pv) | eq;
+    uint64_t ph = *mv | ~(xh | *pv);
+    uint64_t mh = *pv & xh;
+    int delta = (ph & high) ? 1 : (mh & high) ? -1 : 0;
+    ph = (ph << 1) | 1;     /* 第 0 行 D[0][j] = j，每列加 1 */
+    mh <<= 1;
+    *pv = mh | ~(xv | ph);
+    *mv = ph & xv;
+    return delta;
+}
+
+/**
+ * @brief ASCII 快速路径：模式 p（1 到 64 个字节）与文本 t 的编辑距离，字符掩码直接按字节查表
+ */
+static int myers_ascii(const char* p, int m, const char* t, int n, int limit) {
+    uint64_t peq[128];
+    memset(peq, 0, sizeof(peq));
+    for (int i = 0; i < m; i++) peq[(unsigned char)p[i]] |= 1ull << i;
+
+    uint64_t pv = ~0ull, mv = 0, high = 1ull << (m - 1);
+    int score = m;
+    for (int j = 0; j < n; j++) {
+        score += myers_step(peq[(unsigned char)t[j]], &pv, &mv, high);
+        /* 剩下的每列最多使距离减 1 */
+        if (limit >= 0 && score - (n - j - 1) > limit) return limit + 1;
+    }
+    return score;
+}
+
+/**
+ * @brief 一般路径：码点序列上的位并行编辑距离，模式中不同的字符不超过 64 个，按线性查找取掩码
+ */
+static int myers_symbols(const uint32_t* p, int m, const uint32_t* t, int n, int limit) {
+    uint32_t alphabet[WORD_BITS];
+    uint64_t masks[WORD_BITS];
+    int size = 0;
+    for (int i = 0; i < m; i++) {
+        int k = 0;
+        while (k < size && alphabet[k] != p[i]) k++;
+        if (k == size) {
+            alphabet[size] = p[i];
+            masks[size++] = 0;
+        }
+        masks[k] |= 1ull << i;
+    }
+
+    uint64_t pv = ~0ull, mv = 0, high = 1ull << (m - 1);
+    int score = m;
+    for (int j = 0; j < n; j++) {
+        uint64_t eq = 0;
+        for (int k = 0; k < size; k++) {
+            if (alphabet[k] == t[j]) {
+                eq = masks[k];
+                break;
+            }
+        }
+        score += myers_step(eq, &pv, &mv, high);
+        if (limit >= 0 && score - (n - j - 1) > limit) return limit + 1;
+    }
+    return score;
+}
+
+/**
+ * @brief 模式超过 64 个字符时的两行动态规划
+ */
+static int dp_symbols(const uint32_t* p, int m, const uint32_t* t, int n, int limit) {
+    int* row = (int*)malloc(sizeof(int) * (m + 1));
+    if (!row) return -1;
+    for (int i = 0; i <= m; i++) row[i] = i;
+    for (int j = 1; j <= n; j++) {
+        int diag = row[0];
+        int best = row[0] = j;
+        for (int i = 1; i <= m; i++) {
+            int up = row[i];
+            int v = diag + (p[i - 1] != t[j - 1]);
+            if (up + 1 < v) v = up + 1;
+            if (row[i - 1] + 1 < v) v = row[i - 1] + 1;
+            diag = up;
+            row[i] = v;
+            if (v < best) best = v;
+        }
+        /* 每列的最小值不会减小 */
+        if (limit >= 0 && best > limit) {
+            free(row);
+            return limit + 1;
+        }
+    }
+    int d = row[m];
+    free(row);
+    return d;
+}
+
+int editDistance(const char* a, int a_len, const char* b, int b_len, int limit) {
+    /* 以较短的一方作为位向量中的模式 */
+    if (a_len > b_len) {
+        const char* s = a; a = b; b = s;
+        int l = a_len; a_len = b_len; b_len = l;
+    }
+    if (is_ascii(a, a_len) && is_ascii(b, b_len)) {
+        if (limit >= 0 && b_len - a_len > limit) return limit + 1;
+        if (a_len == 0) return b_len;
+        if (a_len <= WORD_BITS) return myers_ascii(a, a_len, b, b_len, limit);
+    }
+
+    uint32_t stack_a[SYMBOL_STACK], stack_b[SYMBOL_STACK];
+    uint32_t* pa = a_len <= SYMBOL_STACK ? stack_a : (uint32_t*)malloc(sizeof(uint32_t) * a_len);
+    uint32_t* pb = b_len <= SYMBOL_STACK ? stack_b : (uint32_t*)malloc(sizeof(uint32_t) * b_len);
+    int d = -1;
+    if (pa && pb) {
+        int m = decode_utf8(a, a_len, pa);
+        int n = decode_utf8(b, b_len, pb);
+        const uint32_t* p = pa; const uint32_t* t = pb;
+        if (m > n) {
+            p = pb; t = pa;
+            int l = m; m = n; n = l;
+        }
+        if (limit >= 0 && n - m > limit) d = limit + 1;
+        else if (m == 0) d = n;
+        else if (m <= WORD_BITS) d = myers_symbols(p, m, t, n, limit);
+        else d = dp_symbols(p, m, t, n, limit);
+    }
+    if (pa != stack_a) free(pa);
+    if (pb != stack_b) free(pb);
+    return d;
+}
+
+struct GradeResult gradeAnswer(const char* answer, const char* expected, const struct GradePolicy* policy) {
+    struct GradePolicy defaults;
+    if (!policy) {
+        gradeDefaultPolicy(&defaults);
+        policy = &defaults;
+    }
+    struct GradeResult result = {GRADE_EXACT, 0, 100};
+    if (strcmp(answer, expected) == 0) return result;
+
+    size_t answer_size = strlen(answer) + 1, expected_size = strlen(expected) + 1;
+    char stack_answer[NORMALIZE_STACK], stack_expected[NORMALIZE_STACK];
+    char* na = answer_size <= NORMALIZE_STACK ? stack_answer : (char*)malloc(answer_size);
+    char* ne = expected_size <= NORMALIZE_STACK ? stack_expected : (char*)malloc(expected_size);
+    int typos = policy->max_typos > 0 ? policy->max_typos : 0;
+    result.verdict = GRADE_WRONG;
+    result.distance = typos + 1;
+    result.credit = 0;
+    if (na && ne) {
+        int na_len = normalize(answer, na, policy);
+        int ne_len = normalize(expected, ne, policy);
+        if (na_len == ne_len && memcmp(na, ne, na_len) == 0) {
+            result.verdict = GRADE_NORMALIZED;
+            result.distance = 0;
+            result.credit = policy->normalized_credit;
+        } else if (na_len > 0) {
+            int d = editDistance(na, na_len, ne, ne_len, typos);
+            if (d >= 0) result.distance = d;
+            if (d > 0 && d <= typos && char_count(ne, ne_len) >= policy->min_typo_length) {
+                result.verdict = GRADE_TYPO;
+                result.credit = policy->typo_credit / d;
+            }
+        }
+    }
+    if (na != stack_answer) free(na);
+    if (ne != stack_expected) free(ne);
+    return result;
+}
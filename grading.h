@@ -0,0 +1,49 @@
+#ifndef GRADING_H
+#define GRADING_H
+
+/*
+ * 答案评分：除完全一致外，对大小写、空白不同或只差少量拼写错误的答案给部分分
+ * 编辑距离使用 Myers 位并行算法，纯 ASCII 的答案走单字长快速路径
+ */
+
+/* 评分结果的类别，按从好到差排列 */
+enum GradeVerdict {
+    GRADE_EXACT,        /* 与正确答案逐字节一致 */
+    GRADE_NORMALIZED,   /* 忽略大小写与空白后一致 */
+    GRADE_TYPO,         /* 编辑距离不超过 GradePolicy.max_typos */
+    GRADE_WRONG
+};
+
+/* 评分阈值，gradeDefaultPolicy 给出 startQuiz 使用的缺省值 */
+struct GradePolicy {
+    int ignore_case;        /* 非 0 时大小写不同按 GRADE_NORMALIZED 处理 */
+    int ignore_space;       /* 非 0 时忽略首尾空白，并把中间连续的空白视为一个空格 */
+    int normalized_credit;  /* GRADE_NORMALIZED 的得分百分比 */
+    int max_typos;          /* 按 GRADE_TYPO 处理的最大编辑距离，0 表示不给拼写错误部分分 */
+    int min_typo_length;    /* 正确答案少于此字符数时不接受拼写错误（短单词差一个字母往往是另一个词） */
+    int typo_credit;        /* GRADE_TYPO 每差一处扣除前的得分百分比，距离为 d 时得 typo_credit / d */
+};
+
+struct GradeResult {
+    enum GradeVerdict verdict;
+    int distance;   /* 规范化后的编辑距离，超过 max_typos 时为 max_typos + 1 */
+    int credit;     /* 得分百分比，0 到 100 */
+};
+
+/* 缺省阈值：忽略大小写与空白并给满分，长度不少于 4 的单词差一处拼写错误给一半分 */
+void gradeDefaultPolicy(struct GradePolicy* policy);
+
+/*
+ * 对 answer 按 expected 评分，policy 为 NULL 时使用缺省阈值
+ * 可重入，不访问数据库，可用于批量重新评分历史答案
+ */
+struct GradeResult gradeAnswer(const char* answer, const char* expected, const struct GradePolicy* policy);
+
+/*
+ * a 与 b 的 Levenshtein 距离（插入、删除、替换各计 1），按字符计算：UTF-8 多字节字符算一个字符
+ * 较短一方不超过 64 个字符时为 O(n) 的位并行算法，否则退回 O(mn) 的动态规划
+ * limit >= 0 时距离超过 limit 即返回 limit + 1（可提前结束），limit < 0 表示不设上限
+ */
+int editDistance(const char* a, int a_len, const char* b, int b_len, int limit);
+
+#endif /* GRADING_H */
@@ -4,6 +4,11 @@
 #include <time.h>
 #include "lib/sqlite3.h"
 #include "database.h"
+#include "connection.h"
+#include "migrate.h"
+#include "question_cache.h"
+#include "load_test_data.h"
+#include "uuid.h"
 
 /**
  * @brief 初始化数据库（创建必要的表）
@@ -33,45 +38,38 @@ int initDatabase(sqlite3* db) {
         fprintf(stderr, "[ERROR] Create answers table failed: %s\n", errmsg);
         return 0;
     }
-    return 1;
+    /* 索引等后续结构变更由迁移完成 */
+    return migrateDatabase(db);
 }
 
 /**
- * @brief 生成 UUID v4，输出 buffer 至至少 37 字节（含终止符）
- * @param out 输出生成结果到 out 中
+ * @brief 取得用户名对应的 UUID（插入被忽略时沿用已有用户的 UUID）
  */
-static void generate_uuid_v4(char out[37]) {
-    unsigned char b[16];
-    for (int i = 0; i < 16; ++i) {
-        b[i] = (unsigned char)(rand() & 0xFF);
-    }
-    /* set version to 4 --- xxxx0100 */
-    b[6] = (b[6] & 0x0F) | 0x40;
-    /* set variant to 10xxxxxx */
-    b[8] = (b[8] & 0x3F) | 0x80;
-    sprintf(out,
-            "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-            b[0], b[1], b[2], b[3],
-            b[4], b[5],
-            b[6], b[7],
-            b[8], b[9],
-            b[10], b[11], b[12], b[13], b[14], b[15]);
+static void existing_uuid(sqlite3* db, const char* username, char out[37]) {
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(db, "SELECT uuid FROM users WHERE username = ?", -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) uuidColumn(stmt, 0, out);
+    }
+    sqlite3_finalize(stmt);
 }
 
 /**
  * @brief 生成测试用户数据。包含 stu0 - stu9。stu0-stu4 班级为 1，stu4-stu9 班级为 2。 
+ * 已存在的测试用户保持不变：INSERT OR REPLACE 会换掉 UUID，且替换时不触发删除触发器，
+ * 旧 UUID 的答题记录、成绩汇总、复习状态与 username_grams 会成为孤立记录
  */
 void load_test_user_data() {
     sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
     int rc;
 
-    // 以时间为种子生成随机数
+    // 以时间为种子生成随机数（供 questionSetPuzzle 等使用）
     srand((unsigned)time(NULL));
 
-    rc = sqlite3_open("vocab_system.db", &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to open Database: %s\n", sqlite3_errmsg(db));
+    db = dbGet();
+    if (!db) {
+        fprintf(stderr, "Failed to open Database\n");
         return;
     }
 
@@ -79,26 +77,24 @@ void load_test_user_data() {
     rc = sqlite3_exec(db, sql, NULL, NULL, NULL);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Transaction Failed: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
         return;
     }
 
-    const char *insert_sql = "INSERT OR REPLACE INTO users "
+    const char *insert_sql = "INSERT OR IGNORE INTO users "
         "(uuid, username, password_hash, user_level, class_name, student_num, teacher_uuid) "
         "VALUES (?, ?, ?, ?, ?, ?, ?);";
     rc = sqlite3_prepare_v2(db, insert_sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "准备插入语句失败: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
         return;
     }
 
     // 插入 teacher0 的测试数据
 
     char teacher0_uuid[37];
-    generate_uuid_v4(teacher0_uuid);
+    uuidV7(teacher0_uuid);
 
-    sqlite3_bind_text(stmt, 1, teacher0_uuid, -1, SQLITE_TRANSIENT); // uuid
+    uuidBind(stmt, 1, teacher0_uuid); // uuid
     sqlite3_bind_text(stmt, 2, "teacher0", -1, SQLITE_TRANSIENT); // username
     sqlite3_bind_text(stmt, 3, "177621", -1, SQLITE_TRANSIENT); // password_hash
     sqlite3_bind_int(stmt, 4, 1); // user_level = 1 (teacher)
@@ -111,18 +107,18 @@ void load_test_user_data() {
         fprintf(stderr, "插入 teacher0 失败: %s\n", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
         sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-        sqlite3_close(db);
         return;
     }
     sqlite3_reset(stmt);
+    existing_uuid(db, "teacher0", teacher0_uuid);
     sqlite3_clear_bindings(stmt);
 
     // 插入 teacher1 的测试数据
 
     char teacher1_uuid[37];
-    generate_uuid_v4(teacher1_uuid);
+    uuidV7(teacher1_uuid);
 
-    sqlite3_bind_text(stmt, 1, teacher1_uuid, -1, SQLITE_TRANSIENT); // uuid
+    uuidBind(stmt, 1, teacher1_uuid); // uuid
     sqlite3_bind_text(stmt, 2, "teacher1", -1, SQLITE_TRANSIENT); // username
     sqlite3_bind_text(stmt, 3, "177621", -1, SQLITE_TRANSIENT); // password_hash
     sqlite3_bind_int(stmt, 4, 1); // user_level = 1 (teacher)
@@ -135,10 +131,10 @@ void load_test_user_data() {
         fprintf(stderr, "插入 teacher1 失败: %s\n", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
         sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-        sqlite3_close(db);
         return;
     }
     sqlite3_reset(stmt);
+    existing_uuid(db, "teacher1", teacher1_uuid);
     sqlite3_clear_bindings(stmt);
 
 
@@ -153,7 +149,7 @@ void load_test_user_data() {
         const char *class_name;
         const char *teacher_uuid;
 
-        generate_uuid_v4(uuid);
+        uuidV7(uuid);
         snprintf(username, sizeof(username), "stu%d", i);
 
         if (i >= 0 && i <= 4) {
@@ -164,20 +160,19 @@ void load_test_user_data() {
             teacher_uuid = teacher1_uuid;
         }
 
-        sqlite3_bind_text(stmt, 1, uuid, -1, SQLITE_TRANSIENT);
+        uuidBind(stmt, 1, uuid);
         sqlite3_bind_text(stmt, 2, username, -1, SQLITE_TRANSIENT);
         sqlite3_bind_text(stmt, 3, password_hash, -1, SQLITE_TRANSIENT);
         sqlite3_bind_int(stmt, 4, user_level);
         sqlite3_bind_text(stmt, 5, class_name, -1, SQLITE_TRANSIENT);
         sqlite3_bind_int(stmt, 6, i+100); // 测试数据学号统一为 10x
-        sqlite3_bind_text(stmt, 7, teacher_uuid, -1, SQLITE_TRANSIENT);
+        uuidBind(stmt, 7, teacher_uuid);
 
         rc = sqlite3_step(stmt);
         if (rc != SQLITE_DONE) {
             fprintf(stderr, "插入 %s 失败: %s\n", username, sqlite3_errmsg(db));
             sqlite3_finalize(stmt);
             sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-            sqlite3_close(db);
             return;
         }
 
@@ -187,7 +182,6 @@ void load_test_user_data() {
 
     sqlite3_finalize(stmt);
     sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
-    sqlite3_close(db);
 
     printf("\n测试数据已写入数据库。\n");
 }
@@ -201,9 +195,9 @@ void load_sample_questions(void) {
     sqlite3_stmt *stmt = NULL;
     int rc;
 
-    rc = sqlite3_open("vocab_system.db", &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "无法打开数据库: %s\n", sqlite3_errmsg(db));
+    db = dbGet();
+    if (!db) {
+        fprintf(stderr, "无法打开数据库\n");
         return;
     }
 
@@ -215,7 +209,6 @@ void load_sample_questions(void) {
         int count = sqlite3_column_int(check_stmt, 0);
         sqlite3_finalize(check_stmt);
         if(count > 0){
-            sqlite3_close(db);
             printf("在当前数据库读取到 %d 道题目。\n", count);
             return;
         }
@@ -226,7 +219,6 @@ void load_sample_questions(void) {
     rc = sqlite3_exec(db, transaction, NULL, NULL, NULL);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to begin transaction: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
         return;
     }
 
@@ -234,7 +226,6 @@ void load_sample_questions(void) {
     rc = sqlite3_prepare_v2(db, insert_sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to insert data: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
         return;
     }
 
@@ -261,7 +252,6 @@ void load_sample_questions(void) {
             fprintf(stderr, "插入题目 %s 失败: %s\n", samples[i][0], sqlite3_errmsg(db));
             sqlite3_finalize(stmt);
             sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
-            sqlite3_close(db);
             return;
         }
 
@@ -271,7 +261,545 @@ void load_sample_questions(void) {
 
     sqlite3_finalize(stmt);
     sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
-    sqlite3_close(db);
+    questionCacheInvalidate();
 
     printf("检测到当前题目数据库为空。已自动加载 10 道样本题目。\n");
-}
\ No newline at end of file
+}
+/* 合成数据：splitmix64 伪随机数，同一种子总是生成相同的数据 */
+static unsigned long long syn_state;
+
+static unsigned long long syn_next(void) {
+    unsigned long long z = (syn_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* [0, 1) 区间的均匀分布 */
+static double syn_uniform(void) {
+    return (syn_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * 由种子确定的 UUIDv7：时间戳从 2026-01-01 起每生成一个递增 1 毫秒，
+ * 与 uuidV7 一样按生成顺序递增
+ */
+static long long syn_clock_ms;
+
+static void syn_uuid(unsigned char b[16]) {
+    unsigned long long ts = (unsigned long long)syn_clock_ms++;
+    unsigned long long hi = (ts << 16) | 0x7000 | (syn_next() & 0x0FFF);
+    unsigned long long lo = (syn_next() & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+    for (int i = 0; i < 8; i++) {
+        b[i] = (unsigned char)(hi >> (56 - 8 * i));
+        b[8 + i] = (unsigned char)(lo >> (56 - 8 * i));
+    }
+}
+
+/*
+ * 第 index 道合成题目的单词：一个随机音节加上 index 按 100 进制编码的音节，末尾再加一个数字
+ * 每个音节固定 2 个字母，因此不同的 index 不会得到相同的单词；真实单词不含数字，
+ * 向已导入 CET4 词库或题目文件的数据库生成时不会违反 questions.word 的唯一约束
+ */
+static void syn_word(int index, char* out, size_t size) {
+    static const char consonants[] = "bcdfghjklmnprstvwxyz";
+    static const char vowels[] = "aeiou";
+    char digits[16];
+    int n = 0;
+    do {
+        digits[n++] = (char)(index % 100);
+        index /= 100;
+    } while (index > 0 && n < (int)sizeof(digits));
+
+    size_t len = 0;
+    int first = (int)(syn_next() % 100);
+    for (int i = -1; i < n && len + 4 <= size; i++) {
+        int d = i < 0 ? first : digits[n - 1 - i];
+        out[len++] = consonants[d / 5];
+        out[len++] = vowels[d % 5];
+    }
+    out[len++] = '0' + first % 10;
+    out[len] = '\0';
+}
+
+/**
+ * @brief 多行 INSERT 写入器：每条语句插入 SYN_ROWS_PER_INSERT 行，最后不足一条语句的部分按剩余行数重新准备
+ */
+struct RowWriter {
+    sqlite3* db;
+    const char* head;       /* "INSERT INTO t (a, b) VALUES " */
+    const char* row;        /* "(?, ?)" */
+    const char* tail;       /* 接在最后一行之后，如 ON CONFLICT 子句，可为 "" */
+    int cols;
+    sqlite3_stmt* stmt;
+    int rows_per_stmt;
+    int filled;
+    long long remaining;
+};
+
+static int writer_prepare(struct RowWriter* w) {
+    sqlite3_finalize(w->stmt);
+    w->stmt = NULL;
+    w->rows_per_stmt = w->remaining < SYN_ROWS_PER_INSERT ? (int)w->remaining : SYN_ROWS_PER_INSERT;
+    if (w->rows_per_stmt <= 0) return 1;
+
+    size_t row_len = strlen(w->row);
+    size_t size = strlen(w->head) + (row_len + 1) * w->rows_per_stmt + strlen(w->tail) + 1;
+    char* sql = (char*)malloc(size);
+    if (!sql) return 0;
+    char* p = sql + sprintf(sql, "%s", w->head);
+    for (int i = 0; i < w->rows_per_stmt; i++) {
+        if (i > 0) *p++ = ',';
+        memcpy(p, w->row, row_len);
+        p += row_len;
+    }
+    strcpy(p, w->tail);
+    int rc = sqlite3_prepare_v2(w->db, sql, -1, &w->stmt, NULL);
+    free(sql);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Prepare SQL failed: %s\n", sqlite3_errmsg(w->db));
+        return 0;
+    }
+    return 1;
+}
+
+static int writer_open(struct RowWriter* w, sqlite3* db, const char* head, const char* row, const char* tail,
+                       int cols, long long total) {
+    w->db = db;
+    w->head = head;
+    w->row = row;
+    w->tail = tail;
+    w->cols = cols;
+    w->stmt = NULL;
+    w->filled = 0;
+    w->remaining = total;
+    return writer_prepare(w);
+}
+
+/* 当前行第 col 列（从 0 开始）的参数序号 */
+static int writer_param(const struct RowWriter* w, int col) {
+    return w->filled * w->cols + col + 1;
+}
+
+/**
+ * @brief 结束当前行，攒满一条语句时执行
+ * @return 成功返回 1
+ */
+static int writer_end_row(struct RowWriter* w) {
+    w->remaining--;
+    if (++w->filled < w->rows_per_stmt) return 1;
+
+    int rc = sqlite3_step(w->stmt);
+    sqlite3_reset(w->stmt);
+    w->filled = 0;
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Insert synthetic data failed: %s\n", sqlite3_errmsg(w->db));
+        return 0;
+    }
+    if (w->remaining > 0 && w->remaining < w->rows_per_stmt) return writer_prepare(w);
+    return 1;
+}
+
+static void writer_close(struct RowWriter* w) {
+    sqlite3_finalize(w->stmt);
+    w->stmt = NULL;
+}
+
+/**
+ * @brief 写入教师与学生，uuids 输出每名学生的 UUID（16 字节，按全局序号）
+ */
+static int syn_insert_users(sqlite3* db, const struct SyntheticSpec* spec, unsigned char (*uuids)[16]) {
+    struct RowWriter w;
+    long long total = (long long)spec->classes * (spec->students_per_class + 1);
+    if (!writer_open(&w, db, "INSERT INTO users (uuid, username, password_hash, user_level, class_name, student_num, teacher_uuid) VALUES ",
+                     "(?, ?, '177621', ?, ?, ?, ?)", "", 6, total)) {
+        return 0;
+    }
+
+    int ok = 1;
+    for (int c = 0; ok && c < spec->classes; c++) {
+        unsigned char teacher_uuid[16];
+        char class_name[32], name[48];
+        syn_uuid(teacher_uuid);
+        snprintf(class_name, sizeof(class_name), SYN_CLASS_NAME, c);
+        snprintf(name, sizeof(name), SYN_TEACHER_NAME, c);
+        sqlite3_bind_blob(w.stmt, writer_param(&w, 0), teacher_uuid, 16, SQLITE_TRANSIENT);
+        sqlite3_bind_text(w.stmt, writer_param(&w, 1), name, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(w.stmt, writer_param(&w, 2), 1);
+        sqlite3_bind_text(w.stmt, writer_param(&w, 3), class_name, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_null(w.stmt, writer_param(&w, 4));
+        sqlite3_bind_null(w.stmt, writer_param(&w, 5));
+        ok = writer_end_row(&w);
+
+        for (int s = 0; ok && s < spec->students_per_class; s++) {
+            int index = c * spec->students_per_class + s;
+            syn_uuid(uuids[index]);
+            snprintf(name, sizeof(name), SYN_STUDENT_NAME, index);
+            sqlite3_bind_blob(w.stmt, writer_param(&w, 0), uuids[index], 16, SQLITE_STATIC);
+            sqlite3_bind_text(w.stmt, writer_param(&w, 1), name, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(w.stmt, writer_param(&w, 2), 2);
+            sqlite3_bind_text(w.stmt, writer_param(&w, 3), class_name, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(w.stmt, writer_param(&w, 4), SYN_FIRST_NUM + index);
+            sqlite3_bind_blob(w.stmt, writer_param(&w, 5), teacher_uuid, 16, SQLITE_TRANSIENT);
+            ok = writer_end_row(&w);
+        }
+    }
+    writer_close(&w);
+    return ok;
+}
+
+/**
+ * @brief 写入题目，first_qid 输出第一道合成题目的 qid
+ * AUTOINCREMENT 在同一事务中连续分配 qid，因此合成题目的 qid 为 first_qid 起的连续区间
+ */
+static int syn_insert_questions(sqlite3* db, const struct SyntheticSpec* spec, sqlite3_int64* first_qid) {
+    static const char* translations[] = {"苹果", "书", "旅程", "王国", "朋友", "房子", "主意", "获取", "工程", "意图"};
+    struct RowWriter w;
+    if (!writer_open(&w, db, "INSERT INTO questions (word, translate, difficulty) VALUES ", "(?, ?, ?)", "", 3, spec->questions)) {
+        return 0;
+    }
+
+    int ok = 1;
+    for (int q = 0; ok && q < spec->questions; q++) {
+        char word[40], translate[64];
+        syn_word(q, word, sizeof(word));
+        snprintf(translate, sizeof(translate), "n.%s%d", translations[syn_next() % 10], q);
+        sqlite3_bind_text(w.stmt, writer_param(&w, 0), word, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(w.stmt, writer_param(&w, 1), translate, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(w.stmt, writer_param(&w, 2), (int)(syn_next() % 5) + 1);
+        ok = writer_end_row(&w);
+    }
+    writer_close(&w);
+    *first_qid = sqlite3_last_insert_rowid(db) - spec->questions + 1;
+    return ok;
+}
+
+/* 每名学生的成绩汇总，生成答题记录时在内存中累计 */
+struct SynStats {
+    long long total_score;
+    int total_questions;
+    int correct_count;
+};
+
+/* 每名学生每个答过的单词的复习状态，按 trg_review_insert 的 SM-2 规则在内存中回放 */
+struct SynReview {
+    int student;
+    int q;
+    int repetitions;
+    int interval_days;
+    double ease;
+};
+
+/* 复习状态缓冲，攒满 SYN_REVIEW_BUFFER 行（至少一名学生的全部单词）后写入 review_state */
+#define SYN_REVIEW_BUFFER 50000
+
+struct SynReviews {
+    sqlite3* db;
+    unsigned char (*uuids)[16];
+    sqlite3_int64 first_qid;
+    long long now;
+    int* slot;      /* 题目序号 -> 当前学生在 rows 中的位置 */
+    int* owner;     /* slot[q] 属于的学生序号 + 1，换学生时不必清空 slot */
+    struct SynReview* rows;
+    int count;
+    int capacity;
+};
+
+static int syn_reviews_open(struct SynReviews* r, sqlite3* db, unsigned char (*uuids)[16],
+                            sqlite3_int64 first_qid, int questions) {
+    r->db = db;
+    r->uuids = uuids;
+    r->first_qid = first_qid;
+    r->now = (long long)time(NULL);
+    r->count = 0;
+    r->capacity = questions > SYN_REVIEW_BUFFER ? questions : SYN_REVIEW_BUFFER;
+    r->slot = (int*)malloc(sizeof(int) * questions);
+    r->owner = (int*)calloc(questions, sizeof(int));
+    r->rows = (struct SynReview*)malloc(sizeof(struct SynReview) * r->capacity);
+    return r->slot && r->owner && r->rows;
+}
+
+/**
+ * @brief 把缓冲中的复习状态写入 review_state，due_at 与触发器相同为 写入时刻 + interval_days 天
+ */
+static int syn_reviews_flush(struct SynReviews* r) {
+    if (r->count == 0) return 1;
+    struct RowWriter w;
+    if (!writer_open(&w, r->db, "INSERT INTO review_state (student_uuid, qid, ease, interval_days, repetitions, due_at) VALUES ",
+                     "(?, ?, ?, ?, ?, ?)", "", 6, r->count)) {
+        return 0;
+    }
+    int ok = 1;
+    for (int i = 0; ok && i < r->count; i++) {
+        const struct SynReview* v = &r->rows[i];
+        sqlite3_bind_blob(w.stmt, writer_param(&w, 0), r->uuids[v->student], 16, SQLITE_STATIC);
+        sqlite3_bind_int64(w.stmt, writer_param(&w, 1), r->first_qid + v->q);
+        sqlite3_bind_double(w.stmt, writer_param(&w, 2), v->ease);
+        sqlite3_bind_int(w.stmt, writer_param(&w, 3), v->interval_days);
+        sqlite3_bind_int(w.stmt, writer_param(&w, 4), v->repetitions);
+        sqlite3_bind_int64(w.stmt, writer_param(&w, 5), r->now + 86400LL * v->interval_days);
+        ok = writer_end_row(&w);
+    }
+    writer_close(&w);
+    r->count = 0;
+    return ok;
+}
+
+/**
+ * @brief 开始回放一名学生的答题，缓冲放不下该学生可能答过的全部单词时先写出
+ */
+static int syn_reviews_begin(struct SynReviews* r, int questions) {
+    return r->count + questions <= r->capacity || syn_reviews_flush(r);
+}
+
+/**
+ * @brief 回放一条答题记录，与 REVIEW_TRIGGERS 的 INSERT ... ON CONFLICT DO UPDATE 相同
+ */
+static void syn_reviews_answer(struct SynReviews* r, int student, int q, int correct) {
+    if (r->owner[q] != student + 1) {
+        struct SynReview* v = &r->rows[r->count];
+        r->owner[q] = student + 1;
+        r->slot[q] = r->count++;
+        v->student = student;
+        v->q = q;
+        v->ease = correct ? 2.6 : 1.96;
+        v->interval_days = correct ? 1 : 0;
+        v->repetitions = correct ? 1 : 0;
+        return;
+    }
+    /* UPSERT 的 SET 中各表达式引用的都是更新前的值 */
+    struct SynReview* v = &r->rows[r->slot[q]];
+    int interval = !correct ? 0 : v->repetitions == 0 ? 1 : v->repetitions == 1 ? 6
+                 : (int)(v->interval_days * v->ease + 0.5);
+    double ease = v->ease + (correct ? 0.1 : -0.54);
+    v->repetitions = correct ? v->repetitions + 1 : 0;
+    v->interval_days = interval;
+    v->ease = ease < 1.3 ? 1.3 : ease;
+}
+
+static void syn_reviews_close(struct SynReviews* r) {
+    free(r->slot);
+    free(r->owner);
+    free(r->rows);
+}
+
+/**
+ * @brief 写入答题记录并累计每名学生的成绩汇总
+ * 每名学生的答题数在 answers_per_student 上下浮动 answer_jitter%，
+ * 正确率在 correct_percent 上下浮动 ability_spread 个百分点；
+ * question_skew 大于 0 时 qid 越小的题目被抽中的概率越高
+ * 同时回放每名学生的复习状态并写入 review_state（答题记录上的触发器此时已删除）
+ */
+static int syn_insert_answers(sqlite3* db, const struct SyntheticSpec* spec, unsigned char (*uuids)[16],
+                              sqlite3_int64 first_qid, struct SynStats* stats, long long* written) {
+    int students = spec->classes * spec->students_per_class;
+    int* counts = (int*)malloc(sizeof(int) * (students > 0 ? students : 1));
+    if (!counts) return 0;
+    long long total = 0;
+    for (int i = 0; i < students; i++) {
+        double jitter = spec->answer_jitter / 100.0 * (2.0 * syn_uniform() - 1.0);
+        counts[i] = (int)(spec->answers_per_student * (1.0 + jitter) + 0.5);
+        if (counts[i] < 0) counts[i] = 0;
+        total += counts[i];
+    }
+
+    struct RowWriter w;
+    struct SynReviews reviews;
+    if (!syn_reviews_open(&reviews, db, uuids, first_qid, spec->questions) ||
+        !writer_open(&w, db, "INSERT INTO answer_records (student_uuid, qid, user_answer, is_correct, score) VALUES ",
+                     "(?, ?, ?, ?, ?)", "", 5, total)) {
+        syn_reviews_close(&reviews);
+        free(counts);
+        return 0;
+    }
+
+    int ok = 1;
+    for (int i = 0; ok && i < students; i++) {
+        ok = syn_reviews_begin(&reviews, spec->questions);
+        double ability = (spec->correct_percent + spec->ability_spread * (2.0 * syn_uniform() - 1.0)) / 100.0;
+        for (int a = 0; ok && a < counts[i]; a++) {
+            double u = syn_uniform();
+            double p = u;
+            for (int k = 0; k < spec->question_skew; k++) p *= u;
+            int q = (int)(spec->questions * p);
+            if (q >= spec->questions) q = spec->questions - 1;
+            int correct = syn_uniform() < ability;
+
+            /* 正确时答案为单词本身，错误时为改动一个字母的拼写 */
+            char answer[40];
+            syn_word(q, answer, sizeof(answer));
+            if (!correct) answer[syn_next() % strlen(answer)] = 'q';
+
+            sqlite3_bind_blob(w.stmt, writer_param(&w, 0), uuids[i], 16, SQLITE_STATIC);
+            sqlite3_bind_int64(w.stmt, writer_param(&w, 1), first_qid + q);
+            sqlite3_bind_text(w.stmt, writer_param(&w, 2), answer, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(w.stmt, writer_param(&w, 3), correct);
+            sqlite3_bind_int(w.stmt, writer_param(&w, 4), correct ? SYN_SCORE : 0);
+            ok = writer_end_row(&w);
+            (*written)++;
+            stats[i].total_score += correct ? SYN_SCORE : 0;
+            stats[i].total_questions++;
+            stats[i].correct_count += correct;
+            syn_reviews_answer(&reviews, i, q, correct);
+        }
+    }
+    writer_close(&w);
+    ok = ok && syn_reviews_flush(&reviews);
+    syn_reviews_close(&reviews);
+    free(counts);
+    return ok;
+}
+
+/**
+ * @brief 将内存中累计的成绩汇总合并到 student_stats
+ */
+static int syn_merge_stats(sqlite3* db, int students, unsigned char (*uuids)[16], const struct SynStats* stats) {
+    int rows = 0;
+    for (int i = 0; i < students; i++) {
+        if (stats[i].total_questions > 0) rows++;
+    }
+
+    struct RowWriter w;
+    if (!writer_open(&w, db, "INSERT INTO student_stats (student_uuid, total_score, total_questions, correct_count) VALUES ",
+                     "(?, ?, ?, ?)",
+                     " ON CONFLICT(student_uuid) DO UPDATE SET total_score = total_score + excluded.total_score,"
+                     " total_questions = total_questions + excluded.total_questions,"
+                     " correct_count = correct_count + excluded.correct_count", 4, rows)) {
+        return 0;
+    }
+    int ok = 1;
+    for (int i = 0; ok && i < students; i++) {
+        if (stats[i].total_questions == 0) continue;
+        sqlite3_bind_blob(w.stmt, writer_param(&w, 0), uuids[i], 16, SQLITE_STATIC);
+        sqlite3_bind_int64(w.stmt, writer_param(&w, 1), stats[i].total_score);
+        sqlite3_bind_int(w.stmt, writer_param(&w, 2), stats[i].total_questions);
+        sqlite3_bind_int(w.stmt, writer_param(&w, 3), stats[i].correct_count);
+        ok = writer_end_row(&w);
+    }
+    writer_close(&w);
+    return ok;
+}
+
+/* answer_records 上的索引与触发器，批量写入期间暂时删除 */
+struct SavedSchema {
+    char** drop_sql;
+    char** create_sql;
+    int count;
+    int dropped;
+};
+
+/**
+ * @brief 删除 answer_records 上的索引与触发器，定义保存在 saved 中
+ * 逐行维护两个索引以及 student_stats、review_state 触发器的开销是写入本身的数倍，
+ * 因此写入时在内存中累计成绩汇总、回放复习状态，写完后重建索引、合并汇总更快
+ */
+static int drop_answer_schema(sqlite3* db, struct SavedSchema* saved) {
+    sqlite3_stmt* stmt = NULL;
+    /* 先索引后触发器，恢复时按同样的顺序执行 */
+    if (sqlite3_prepare_v2(db, "SELECT type, name, sql FROM sqlite_master WHERE tbl_name = 'answer_records' "
+                           "AND type IN ('index', 'trigger') AND sql IS NOT NULL ORDER BY type = 'trigger'",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Read schema failed: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+
+    int ok = 1;
+    while (ok && sqlite3_step(stmt) == SQLITE_ROW) {
+        char** drops = (char**)realloc(saved->drop_sql, sizeof(char*) * (saved->count + 1));
+        if (drops) saved->drop_sql = drops;
+        char** creates = (char**)realloc(saved->create_sql, sizeof(char*) * (saved->count + 1));
+        if (creates) saved->create_sql = creates;
+        if (!drops || !creates) {
+            ok = 0;
+            break;
+        }
+        saved->drop_sql[saved->count] = sqlite3_mprintf("DROP %s \"%w\"", (const char*)sqlite3_column_text(stmt, 0),
+                                                        (const char*)sqlite3_column_text(stmt, 1));
+        saved->create_sql[saved->count] = sqlite3_mprintf("%s", (const char*)sqlite3_column_text(stmt, 2));
+        saved->count++;
+    }
+    /* 读取 sqlite_master 的语句结束之前不能修改表结构 */
+    sqlite3_finalize(stmt);
+
+    for (int i = 0; ok && i < saved->count; i++) {
+        if (!saved->drop_sql[i] || !saved->create_sql[i]
+            || sqlite3_exec(db, saved->drop_sql[i], NULL, NULL, NULL) != SQLITE_OK) {
+            fprintf(stderr, "[ERROR] Drop schema object failed: %s\n", sqlite3_errmsg(db));
+            ok = 0;
+        } else {
+            saved->dropped++;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief 按保存的定义重建已删除的索引与触发器，并释放 saved
+ */
+static int restore_answer_schema(sqlite3* db, struct SavedSchema* saved) {
+    int ok = 1;
+    for (int i = 0; i < saved->count; i++) {
+        if (ok && i < saved->dropped && sqlite3_exec(db, saved->create_sql[i], NULL, NULL, NULL) != SQLITE_OK) {
+            fprintf(stderr, "[ERROR] Restore schema failed: %s\n", sqlite3_errmsg(db));
+            ok = 0;
+        }
+        sqlite3_free(saved->drop_sql[i]);
+        sqlite3_free(saved->create_sql[i]);
+    }
+    free(saved->drop_sql);
+    free(saved->create_sql);
+    return ok;
+}
+
+/**
+ * @brief 按规格生成合成数据：classes 个班级（每班一名教师）、每班 students_per_class 名学生、
+ * questions 道题目以及按分布生成的答题记录。种子相同则生成的数据完全相同
+ * 用户名、班级与学号的格式见 SYN_STUDENT_NAME 等宏，密码均为 "0"
+ * 用户名与单词唯一，因此只能向没有合成数据的数据库中生成一次
+ * 全部数据在一个事务中写入，失败时数据库（包括暂时删除的索引与触发器）保持不变
+ * @return 成功返回 1
+ */
+int load_synthetic_data(const struct SyntheticSpec* spec) {
+    sqlite3 *db = dbGet();
+    if (!db) {
+        fprintf(stderr, "[ERROR] Cannot open database\n");
+        return 0;
+    }
+    if (spec->classes < 0 || spec->students_per_class < 0 || spec->questions <= 0 || spec->answers_per_student < 0) {
+        fprintf(stderr, "[ERROR] Invalid synthetic data spec\n");
+        return 0;
+    }
+
+    int students = spec->classes * spec->students_per_class;
+    unsigned char (*uuids)[16] = (unsigned char (*)[16])malloc(16 * (size_t)(students > 0 ? students : 1));
+    struct SynStats* stats = (struct SynStats*)calloc(students > 0 ? students : 1, sizeof(struct SynStats));
+    if (!uuids || !stats) {
+        free(uuids);
+        free(stats);
+        return 0;
+    }
+
+    syn_state = spec->seed;
+    syn_clock_ms = 1767225600000LL;
+    sqlite3_int64 first_qid = 0;
+    long long answers = 0;
+    struct SavedSchema saved = {NULL, NULL, 0, 0};
+    int ok = dbBegin();
+    ok = ok && syn_insert_users(db, spec, uuids);
+    ok = ok && syn_insert_questions(db, spec, &first_qid);
+    ok = ok && drop_answer_schema(db, &saved);
+    ok = ok && syn_insert_answers(db, spec, uuids, first_qid, stats, &answers);
+    ok = restore_answer_schema(db, &saved) && ok;
+    ok = ok && syn_merge_stats(db, students, uuids, stats);
+    ok = ok && dbCommit();
+    if (!ok) dbRollback();
+    questionCacheInvalidate();
+    free(uuids);
+    free(stats);
+
+    if (ok) {
+        printf("[INFO] Generated %d classes, %d students, %d questions, %lld answers (seed %llu)\n",
+               spec->classes, students, spec->questions, answers, spec->seed);
+    }
+    return ok;
+}
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <string.h>
+#include "migrate.h"
+#include "stmt_cache.h"
+
+/* 维护 student_stats 的触发器，重建 answer_records 时需要重新创建 */
+#define STATS_TRIGGERS \
+    "CREATE TRIGGER IF NOT EXISTS trg_stats_insert AFTER INSERT ON answer_records " \
+    "WHEN NEW.student_uuid IS NOT NULL BEGIN " \
+    "  INSERT INTO student_stats (student_uuid, total_score, total_questions, correct_count) " \
+    "  VALUES (NEW.student_uuid, COALESCE(NEW.score, 0), 1, COALESCE(NEW.is_correct, 0)) " \
+    "  ON CONFLICT(student_uuid) DO UPDATE SET " \
+    "    total_score = total_score + excluded.total_score," \
+    "    total_questions = total_questions + 1," \
+    "    correct_count = correct_count + excluded.correct_count;" \
+    "END;" \
+    "CREATE TRIGGER IF NOT EXISTS trg_stats_delete AFTER DELETE ON answer_records " \
+    "WHEN OLD.student_uuid IS NOT NULL BEGIN " \
+    "  UPDATE student_stats SET " \
+    "    total_score = total_score - COALESCE(OLD.score, 0)," \
+    "    total_questions = total_questions - 1," \
+    "    correct_count = correct_count - COALESCE(OLD.is_correct, 0) " \
+    "  WHERE student_uuid = OLD.student_uuid;" \
+    "END;" \
+    "CREATE TRIGGER IF NOT EXISTS trg_stats_update AFTER UPDATE OF student_uuid, score, is_correct ON answer_records BEGIN " \
+    "  UPDATE student_stats SET " \
+    "    total_score = total_score - COALESCE(OLD.score, 0)," \
+    "    total_questions = total_questions - 1," \
+    "    correct_count = correct_count - COALESCE(OLD.is_correct, 0) " \
+    "  WHERE student_uuid = OLD.student_uuid;" \
+    "  INSERT INTO student_stats (student_uuid, total_score, total_questions, correct_count) " \
+    "  SELECT NEW.student_uuid, COALESCE(NEW.score, 0), 1, COALESCE(NEW.is_correct, 0) " \
+    "  WHERE NEW.student_uuid IS NOT NULL " \
+    "  ON CONFLICT(student_uuid) DO UPDATE SET " \
+    "    total_score = total_score + excluded.total_score," \
+    "    total_questions = total_questions + 1," \
+    "    correct_count = correct_count + excluded.correct_count;" \
+    "END;"
+
+/*
+ * 间隔重复（SM-2）的下一次复习间隔（天），在 review_state 的 UPSERT 中引用已有行的列：
+ * 答错归零（下次测验立即复习），连续答对第 1、2 次分别为 1、6 天，之后乘以 ease
+ */
+#define REVIEW_NEXT_INTERVAL \
+    "CASE WHEN COALESCE(NEW.is_correct, 0) = 0 THEN 0 " \
+    "WHEN repetitions = 0 THEN 1 WHEN repetitions = 1 THEN 6 " \
+    "ELSE CAST(ROUND(interval_days * ease) AS INTEGER) END"
+
+/* 每条答题记录写入后更新该学生该单词的复习状态，与 student_stats 的触发器在同一事务中执行 */
+#define REVIEW_TRIGGERS \
+    "CREATE TRIGGER IF NOT EXISTS trg_review_insert AFTER INSERT ON answer_records " \
+    "WHEN NEW.student_uuid IS NOT NULL AND NEW.qid IS NOT NULL BEGIN " \
+    "  INSERT INTO review_state (student_uuid, qid, ease, interval_days, repetitions, due_at) " \
+    "  VALUES (NEW.student_uuid, NEW.qid, CASE WHEN COALESCE(NEW.is_correct, 0) THEN 2.6 ELSE 1.96 END, " \
+    "          CASE WHEN COALESCE(NEW.is_correct, 0) THEN 1 ELSE 0 END, " \
+    "          CASE WHEN COALESCE(NEW.is_correct, 0) THEN 1 ELSE 0 END, " \
+    "          unixepoch() + CASE WHEN COALESCE(NEW.is_correct, 0) THEN 86400 ELSE 0 END) " \
+    "  ON CONFLICT(student_uuid, qid) DO UPDATE SET " \
+    "    repetitions = CASE WHEN COALESCE(NEW.is_correct, 0) THEN repetitions + 1 ELSE 0 END," \
+    "    interval_days = " REVIEW_NEXT_INTERVAL "," \
+    "    ease = MAX(1.3, ease + CASE WHEN COALESCE(NEW.is_correct, 0) THEN 0.1 ELSE -0.54 END)," \
+    "    due_at = unixepoch() + 86400 * (" REVIEW_NEXT_INTERVAL ");" \
+    "END;"
+
+/*
+ * 用户名的小写 n-gram：把用户名转为 BLOB 后按字节取相邻两字节与相邻三字节，
+ * 与位置表 gram_positions 连接生成（触发器中不能使用 WITH）。
+ * 按字符取时 substr 按 UTF-8 解码 GBK 的用户名，会把前一个汉字的尾字节与后一个汉字连在一起，
+ * 从名字中间开始的关键字切出的 n-gram 就对不上
+ */
+#define USERNAME_BYTES(row) "CAST(lower(" row ".username) AS BLOB)"
+#define USERNAME_GRAMS_OF(row) \
+    "SELECT substr(" USERNAME_BYTES(row) ", n, 2) AS gram FROM gram_positions WHERE n < length(" USERNAME_BYTES(row) ") " \
+    "UNION ALL SELECT substr(" USERNAME_BYTES(row) ", n, 3) FROM gram_positions WHERE n < length(" USERNAME_BYTES(row) ") - 1"
+
+/* 维护 username_grams 的触发器，重建 users 时需要重新创建 */
+#define USERNAME_GRAM_TRIGGERS \
+    "CREATE TRIGGER IF NOT EXISTS trg_username_grams_insert AFTER INSERT ON users BEGIN " \
+    "  INSERT OR IGNORE INTO username_grams (gram, uuid) SELECT gram, NEW.uuid FROM (" USERNAME_GRAMS_OF("NEW") ");" \
+    "END;" \
+    "CREATE TRIGGER IF NOT EXISTS trg_username_grams_delete AFTER DELETE ON users BEGIN " \
+    "  DELETE FROM username_grams WHERE uuid = OLD.uuid AND gram IN (" USERNAME_GRAMS_OF("OLD") ");" \
+    "END;" \
+    "CREATE TRIGGER IF NOT EXISTS trg_username_grams_update AFTER UPDATE OF uuid, username ON users BEGIN " \
+    "  DELETE FROM username_grams WHERE uuid = OLD.uuid AND gram IN (" USERNAME_GRAMS_OF("OLD") ");" \
+    "  INSERT OR IGNORE INTO username_grams (gram, uuid) SELECT gram, NEW.uuid FROM (" USERNAME_GRAMS_OF("NEW") ");" \
+    "END;"
+
+/* 删除用户时清理该学生的全部数据，重建 users 时需要重新创建 */
+#define USER_CASCADE_TRIGGER \
+    "CREATE TRIGGER IF NOT EXISTS trg_users_cascade AFTER DELETE ON users BEGIN " \
+    "  DELETE FROM student_stats WHERE student_uuid = OLD.uuid;" \
+    "  DELETE FROM review_state WHERE student_uuid = OLD.uuid;" \
+    "  DELETE FROM answer_records WHERE student_uuid = OLD.uuid;" \
+    "END;"
+
+/* 第 N 个元素把表结构从版本 N 升级到 N + 1，只能追加，不能修改已发布的迁移 */
+static const char* const migrations[] = {
+    /* 1: 成绩查询所需的索引。idx_answer_student 覆盖 JOIN 中用到的 score、is_correct 与 aid */
+    "CREATE INDEX IF NOT EXISTS idx_answer_student ON answer_records(student_uuid, score, is_correct);"
+    "CREATE INDEX IF NOT EXISTS idx_answer_qid ON answer_records(qid);"
+    "CREATE INDEX IF NOT EXISTS idx_users_class ON users(class_name, user_level);"
+    "CREATE INDEX IF NOT EXISTS idx_users_level_num ON users(user_level, student_num);",
+
+    /* 2: 每个学生的成绩汇总，由触发器在写入答题记录的同一事务中维护 */
+    "CREATE TABLE IF NOT EXISTS student_stats ("
+    "  student_uuid TEXT PRIMARY KEY,"
+    "  total_score INTEGER NOT NULL DEFAULT 0,"
+    "  total_questions INTEGER NOT NULL DEFAULT 0,"
+    "  correct_count INTEGER NOT NULL DEFAULT 0"
+    ") WITHOUT ROWID;"
+    STATS_TRIGGERS
+    "DELETE FROM student_stats;"
+    "INSERT INTO student_stats (student_uuid, total_score, total_questions, correct_count) "
+    "SELECT student_uuid, COALESCE(SUM(score), 0), COUNT(*), COALESCE(SUM(is_correct), 0) "
+    "FROM answer_records WHERE student_uuid IS NOT NULL GROUP BY student_uuid;",
+
+    /*
+     * 3: UUID 改为 16 字节 BLOB 存储（uuid_blob() 由 uuidRegisterFunctions 注册）
+     * SQLite 不能修改列类型，按 新建表 - 复制 - 删除旧表 - 改名 的方式重建三张表，
+     * 删除旧表时其索引与触发器一并删除，之后重新创建
+     */
+    "CREATE TABLE users_new (uuid BLOB PRIMARY KEY, username TEXT NOT NULL UNIQUE, password_hash TEXT NOT NULL,"
+    "  user_level INTEGER, class_name TEXT, student_num INTEGER, teacher_uuid BLOB);"
+    "INSERT INTO users_new SELECT uuid_blob(uuid), username, password_hash, user_level, class_name, student_num,"
+    "  uuid_blob(teacher_uuid) FROM users;"
+    "DROP TABLE users;"
+    "ALTER TABLE users_new RENAME TO users;"
+    "CREATE INDEX idx_users_class ON users(class_name, user_level);"
+    "CREATE INDEX idx_users_level_num ON users(user_level, student_num);"
+    "CREATE TABLE answer_records_new (aid INTEGER PRIMARY KEY AUTOINCREMENT, student_uuid BLOB, qid INTEGER,"
+    "  user_answer TEXT, is_correct INTEGER, score INTEGER);"
+    "INSERT INTO answer_records_new SELECT aid, uuid_blob(student_uuid), qid, user_answer, is_correct, score"
+    "  FROM answer_records ORDER BY aid;"
+    "DROP TABLE answer_records;"
+    "ALTER TABLE answer_records_new RENAME TO answer_records;"
+    "CREATE INDEX idx_answer_student ON answer_records(student_uuid, score, is_correct);"
+    "CREATE INDEX idx_answer_qid ON answer_records(qid);"
+    "DROP TABLE student_stats;"
+    "CREATE TABLE student_stats ("
+    "  student_uuid BLOB PRIMARY KEY,"
+    "  total_score INTEGER NOT NULL DEFAULT 0,"
+    "  total_questions INTEGER NOT NULL DEFAULT 0,"
+    "  correct_count INTEGER NOT NULL DEFAULT 0"
+    ") WITHOUT ROWID;"
+    STATS_TRIGGERS
+    "INSERT INTO student_stats (student_uuid, total_score, total_questions, correct_count) "
+    "SELECT student_uuid, COALESCE(SUM(score), 0), COUNT(*), COALESCE(SUM(is_correct), 0) "
+    "FROM answer_records WHERE student_uuid IS NOT NULL GROUP BY student_uuid;",
+
+    /*
+     * 4: 间隔重复的复习状态，每个学生每个单词一行；idx_review_due 使"取出最早到期的 N 个单词"
+     * 成为一次索引范围扫描。已有的答题历史不回放，答过的单词一律视为立即到期
+     */
+    "CREATE TABLE review_state ("
+    "  student_uuid BLOB NOT NULL,"
+    "  qid INTEGER NOT NULL,"
+    "  ease REAL NOT NULL DEFAULT 2.5,"
+    "  interval_days INTEGER NOT NULL DEFAULT 0,"
+    "  repetitions INTEGER NOT NULL DEFAULT 0,"
+    "  due_at INTEGER NOT NULL,"
+    "  PRIMARY KEY (student_uuid, qid)"
+    ") WITHOUT ROWID;"
+    "CREATE INDEX idx_review_due ON review_state(student_uuid, due_at);"
+    REVIEW_TRIGGERS
+    "INSERT INTO review_state (student_uuid, qid, due_at) "
+    "SELECT DISTINCT student_uuid, qid, unixepoch() FROM answer_records "
+    "WHERE student_uuid IS NOT NULL AND qid IS NOT NULL;",
+
+    /* 5: 按难度组卷时在一个难度内扫描（该难度题目较少时） */
+    "CREATE INDEX idx_questions_difficulty ON questions(difficulty);",
+    /*
+     * 6: 按姓名包含查询成绩时的 n-gram 索引，用户名中每个相邻两字、三字各一行，由触发器随 users 维护；
+     * gram_positions 为 1 到 255 的位置表，用户名超出的部分不建索引
+     */
+    "CREATE TABLE gram_positions (n INTEGER PRIMARY KEY);"
+    "INSERT INTO gram_positions WITH RECURSIVE c(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM c WHERE n < 255) "
+    "SELECT n FROM c;"
+    "CREATE TABLE username_grams ("
+    "  gram TEXT NOT NULL,"
+    "  uuid BLOB NOT NULL,"
+    "  PRIMARY KEY (gram, uuid)"
+    ") WITHOUT ROWID;"
+    USERNAME_GRAM_TRIGGERS
+    "INSERT OR IGNORE INTO username_grams (gram, uuid) "
+    "SELECT lower(substr(u.username, p.n, 2)), u.uuid FROM users u JOIN gram_positions p ON p.n < length(u.username) "
+    "UNION ALL "
+    "SELECT lower(substr(u.username, p.n, 3)), u.uuid FROM users u JOIN gram_positions p ON p.n < length(u.username) - 1;",
+
+    /*
+     * 7: 删除用户时级联删除其成绩汇总、复习状态与答题记录，都是按 student_uuid 的索引前缀删除；
+     * 先删汇总，之后每删一条答题记录触发的汇总更新都找不到行。同时清理此前删除用户留下的孤立记录
+     */
+    USER_CASCADE_TRIGGER
+    "DELETE FROM student_stats WHERE student_uuid NOT IN (SELECT uuid FROM users);"
+    "DELETE FROM review_state WHERE student_uuid NOT IN (SELECT uuid FROM users);"
+    "DELETE FROM answer_records WHERE student_uuid IS NOT NULL AND student_uuid NOT IN (SELECT uuid FROM users);",
+
+    /*
+     * 8: 启动时写入测试用户曾用 INSERT OR REPLACE，替换行不触发删除触发器，
+     * 每次启动都会留下旧 UUID 的记录；改为 INSERT OR IGNORE 后清理一次，包括 username_grams
+     */
+    "DELETE FROM student_stats WHERE student_uuid NOT IN (SELECT uuid FROM users);"
+    "DELETE FROM review_state WHERE student_uuid NOT IN (SELECT uuid FROM users);"
+    "DELETE FROM answer_records WHERE student_uuid IS NOT NULL AND student_uuid NOT IN (SELECT uuid FROM users);"
+    "DELETE FROM username_grams WHERE uuid NOT IN (SELECT uuid FROM users);",
+
+    /* 9: username_grams 改为按字节取 n-gram（见 USERNAME_GRAMS_OF），重建触发器与全部 n-gram */
+    "DROP TRIGGER trg_username_grams_insert;"
+    "DROP TRIGGER trg_username_grams_delete;"
+    "DROP TRIGGER trg_username_grams_update;"
+    USERNAME_GRAM_TRIGGERS
+    "DELETE FROM username_grams;"
+    "INSERT OR IGNORE INTO username_grams (gram, uuid) "
+    "SELECT substr(" USERNAME_BYTES("u") ", p.n, 2), u.uuid FROM users u "
+    "JOIN gram_positions p ON p.n < length(" USERNAME_BYTES("u") ") "
+    "UNION ALL "
+    "SELECT substr(" USERNAME_BYTES("u") ", p.n, 3), u.uuid FROM users u "
+    "JOIN gram_positions p ON p.n < length(" USERNAME_BYTES("u") ") - 1;",
+};
+
+#define MIGRATION_COUNT ((int)(sizeof(migrations) / sizeof(migrations[0])))
+
+int latestSchemaVersion(void) {
+    return MIGRATION_COUNT;
+}
+
+/**
+ * @brief 读取 PRAGMA user_version
+ * @return 版本号，失败返回 -1
+ */
+static int get_user_version(sqlite3* db) {
+    sqlite3_stmt* stmt = NULL;
+    int version = -1;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+/**
+ * @brief 把旧数据库转换为 auto_vacuum = INCREMENTAL
+ * 新建的数据库在打开连接时已设置（见 connection.c），旧数据库只能用一次 VACUUM 转换，
+ * 它不能在事务中执行，因此不作为普通迁移；之后删除数据释放的页由 dbReclaimSpace 分步归还
+ * @return 成功返回 1，失败返回 0
+ */
+static int enable_incremental_vacuum(sqlite3* db) {
+    sqlite3_stmt* stmt = NULL;
+    int mode = -1;
+    if (sqlite3_prepare_v2(db, "PRAGMA auto_vacuum", -1, &stmt, NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        mode = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    if (mode != 0) return mode > 0;
+
+    char* errmsg = NULL;
+    if (sqlite3_exec(db, "PRAGMA auto_vacuum = INCREMENTAL; VACUUM;", NULL, NULL, &errmsg) != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Enable incremental auto_vacuum failed: %s\n", errmsg);
+        sqlite3_free(errmsg);
+        return 0;
+    }
+    printf("[INFO] Database converted to incremental auto_vacuum\n");
+    return 1;
+}
+
+/**
+ * @brief 执行尚未应用的迁移
+ * @return 成功返回 1，失败返回 0
+ */
+int migrateDatabase(sqlite3* db) {
+    int version = get_user_version(db);
+    if (version < 0) {
+        fprintf(stderr, "[ERROR] Read schema version failed: %s\n", sqlite3_errmsg(db));
+        return 0;
+    }
+
+    for (; version < MIGRATION_COUNT; version++) {
+        char* errmsg = NULL;
+        char set_version[64];
+        snprintf(set_version, sizeof(set_version), "PRAGMA user_version = %d", version + 1);
+
+        if (sqlite3_exec(db, "BEGIN IMMEDIATE", NULL, NULL, &errmsg) != SQLITE_OK ||
+            sqlite3_exec(db, migrations[version], NULL, NULL, &errmsg) != SQLITE_OK ||
+            sqlite3_exec(db, set_version, NULL, NULL, &errmsg) != SQLITE_OK ||
+            sqlite3_exec(db, "COMMIT", NULL, NULL, &errmsg) != SQLITE_OK) {
+            fprintf(stderr, "[ERROR] Migration to version %d failed: %s\n", version + 1, errmsg);
+            sqlite3_free(errmsg);
+            if (!sqlite3_get_autocommit(db)) sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+            return 0;
+        }
+        printf("[INFO] Database schema migrated to version %d\n", version + 1);
+    }
+    return enable_incremental_vacuum(db);
+}
+
+/* 需要检查的成绩、复习、组卷查询与删除用户的语句；按姓名包含查询的关键字不足两个字节时没有 n-gram，只能扫描 users */
+static const struct {
+    enum StmtId id;
+    int allow_user_scan;
+} grade_queries[] = {
+    {STMT_GRADES_BY_NAME, 1},
+    {STMT_GRADES_BY_NAME_GRAMS, 0},
+    {STMT_GRADES_BY_NAME_PREFIX, 0},
+    {STMT_GRADES_BY_NAME_EXACT, 0},
+    {STMT_GRADES_BY_CLASS, 0},
+    {STMT_GRADES_BY_NUM_RANGE, 0},
+    {STMT_EXPORT_BY_SCORE, 0},
+    {STMT_EXPORT_BY_CLASS, 0},
+    {STMT_REVIEW_DUE, 0},
+    {STMT_QUESTION_IN_BUCKET, 0},
+    {STMT_USER_DELETE, 0},
+    {STMT_USERS_DELETE_BY_CLASS, 0},
+    {STMT_USERS_DELETE_BY_NUM_RANGE, 0},
+};
+
+/**
+ * @brief 检查成绩查询是否都走索引
+ * @return 全部通过返回 1，否则返回 0
+ */
+int verifyGradeQueryPlans(sqlite3* db) {
+    int ok = 1;
+    for (size_t i = 0; i < sizeof(grade_queries) / sizeof(grade_queries[0]); i++) {
+        char* sql = sqlite3_mprintf("EXPLAIN QUERY PLAN %s", stmtSql(grade_queries[i].id));
+        sqlite3_stmt* stmt = NULL;
+        int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+        sqlite3_free(sql);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "[ERROR] EXPLAIN failed: %s\n", sqlite3_errmsg(db));
+            return 0;
+        }
+
+        int full_scan = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* detail = (const char*)sqlite3_column_text(stmt, 3);
+            if (!detail || strncmp(detail, "SCAN ", 5) != 0) continue;
+            /* 子查询的结果由协程逐行产生，不是表扫描 */
+            if (strncmp(detail, "SCAN (subquery-", 15) == 0) continue;
+            if (grade_queries[i].allow_user_scan && strncmp(detail, "SCAN u", 6) == 0 &&
+                (detail[6] == '\0' || detail[6] == ' ')) continue;
+            fprintf(stderr, "[FAIL] %s\n       %s\n", stmtSql(grade_queries[i].id), detail);
+            full_scan = 1;
+        }
+        sqlite3_finalize(stmt);
+        if (full_scan) ok = 0;
+    }
+    return ok;
+}
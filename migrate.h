@@ -0,0 +1,22 @@
+#ifndef MIGRATE_H
+#define MIGRATE_H
+
+#include "lib/sqlite3.h"
+
+/*
+ * 按 PRAGMA user_version 依次执行尚未应用的迁移，每个版本一个事务
+ * 之后把仍为 auto_vacuum = NONE 的旧数据库用一次 VACUUM 转换为 INCREMENTAL
+ * 成功返回 1，失败返回 0（失败的版本会被回滚）
+ */
+int migrateDatabase(sqlite3* db);
+
+/* 当前代码对应的最新表结构版本 */
+int latestSchemaVersion(void);
+
+/*
+ * 对所有成绩查询、到期复习、按难度组卷的查询与删除用户的语句执行 EXPLAIN QUERY PLAN，若出现
+ * 全表扫描（按姓名查询对 users 的扫描除外）则打印查询计划并返回 0
+ */
+int verifyGradeQueryPlans(sqlite3* db);
+
+#endif /* MIGRATE_H */
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "question_cache.h"
+#include "connection.h"
+#include "stmt_cache.h"
+#include "timer.h"
+#include "lib/sqlite3.h"
+
+static struct QuestionSet questions;
+static int valid;
+/* 读取题库时共享连接的 PRAGMA data_version，其他连接或进程提交修改后会变化 */
+static long long data_version;
+static struct QuestionCacheStats stats;
+/* 每次重新读取或直接修改题库后加 1，供依赖题库的派生数据（如搜索索引）判断是否过期 */
+static long long generation;
+
+/**
+ * @brief 查询共享连接的 data_version
+ * 本连接自己提交的修改不会改变该值，因此本进程的增删题目需另行调用 questionCacheInvalidate
+ * @return 出错返回 -1
+ */
+static long long current_data_version(void) {
+    sqlite3_stmt* stmt = stmtGet(STMT_DATA_VERSION);
+    if (!stmt) return -1;
+    long long v = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+    stmtRelease(stmt);
+    return v;
+}
+
+/**
+ * @brief 从数据库读取全部题目，替换当前缓存
+ * @return 成功返回 1
+ */
+static int load_questions(long long version) {
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_ALL_BY_QID);
+    if (!stmt) return 0;
+    
+    long long start = timerNowNs();
+    struct QuestionSet set;
+    questionSetInit(&set);
+    int ok = 1;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* w = (const char*)sqlite3_column_text(stmt, 1);
+        int w_len = sqlite3_column_bytes(stmt, 1);
+        const char* t = (const char*)sqlite3_column_text(stmt, 2);
+        int t_len = sqlite3_column_bytes(stmt, 2);
+        if (!questionSetAppend(&set, sqlite3_column_int(stmt, 0), w ? w : "", w_len, t ? t : "", t_len)) {
+            ok = 0;
+            break;
+        }
+    }
+    stmtRelease(stmt);
+    
+    if (!ok || rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Load questions failed: %s\n", ok ? sqlite3_errmsg(dbGet()) : "out of memory");
+        questionSetFree(&set);
+        return 0;
+    }
+    
+    questionSetShrink(&set);
+    questionSetFree(&questions);
+    questions = set;
+    data_version = version;
+    valid = 1;
+    generation++;
+    stats.loads++;
+    stats.load_ns += timerNowNs() - start;
+    return 1;
+}
+
+/**
+ * @brief 取得缓存的题库，必要时重新读取
+ * @return 题目集合；出错返回 NULL
+ */
+const struct QuestionSet* questionCacheGet(void) {
+    if (!dbGet()) return NULL;
+    
+    long long version = current_data_version();
+    if (valid && version != -1 && version == data_version) {
+        stats.hits++;
+    } else if (!load_questions(version)) {
+        return NULL;
+    }
+    return &questions;
+}
+
+long long questionCacheGeneration(void) {
+    return generation;
+}
+
+void questionCacheInvalidate(void) {
+    valid = 0;
+}
+
+/**
+ * @brief 能否直接修改缓存：显式事务中的修改可能被回滚，此时只能重新读取
+ */
+static int can_patch(void) {
+    return valid && sqlite3_get_autocommit(dbGet());
+}
+
+/**
+ * @brief 把本进程新增的题目追加到缓存；新 qid 通常是最大的 rowid，否则重新读取以保持按 qid 升序
+ * @return 题目在集合中的下标，缓存被标记为失效时返回 -1
+ */
+int questionCacheAdded(int qid, const char* word, const char* translate) {
+    if (!can_patch() || (questions.count > 0 && qid <= questions.qids[questions.count - 1])
+        || !questionSetAppend(&questions, qid, word, strlen(word), translate, strlen(translate))) {
+        valid = 0;
+        return -1;
+    }
+    generation++;
+    return questions.count - 1;
+}
+
+/**
+ * @brief 从缓存中移除本进程删除的题目（按 qid 二分查找）
+ * @return 题目原来的下标；不在缓存中或缓存被标记为失效时返回 -1
+ */
+int questionCacheDeleted(int qid) {
+    if (!can_patch()) {
+        valid = 0;
+        return -1;
+    }
+    int l = 0, h = questions.count;
+    while (l < h) {
+        int mid = l + (h - l) / 2;
+        if (questions.qids[mid] < qid) l = mid + 1;
+        else h = mid;
+    }
+    if (l == questions.count || questions.qids[l] != qid) return -1;
+    questionSetRemove(&questions, l);
+    generation++;
+    return l;
+}
+
+/**
+ * @brief 释放缓存的题库
+ */
+void questionCacheClear(void) {
+    questionSetFree(&questions);
+    valid = 0;
+    generation++;
+}
+
+void questionCacheGetStats(struct QuestionCacheStats* out) {
+    if (out) *out = stats;
+}
+
+void questionCacheResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
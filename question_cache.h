@@ -0,0 +1,45 @@
+#ifndef QUESTION_CACHE_H
+#define QUESTION_CACHE_H
+
+#include "question_set.h"
+
+/* 题库缓存的统计数据 */
+struct QuestionCacheStats {
+    long long hits;      /* 直接使用内存中题库的次数 */
+    long long loads;     /* 从数据库重新读取题库的次数 */
+    long long load_ns;   /* 读取题库累计耗时（纳秒） */
+};
+
+/*
+ * 取得按 qid 升序排列的全部题目
+ * 首次调用或题库发生变化后从数据库读取，否则直接返回内存中的集合
+ * 返回的集合归缓存所有，调用方不得修改或释放，下次调用本模块函数后失效
+ * 出错时返回 NULL（题库为空时返回 count 为 0 的集合）
+ */
+const struct QuestionSet* questionCacheGet(void);
+
+/* 题库内容的版本号：每次重新读取或直接修改题库后加 1，用于判断派生数据是否过期 */
+long long questionCacheGeneration(void);
+
+/* 标记题库已被本进程修改（增删题目后调用），下次取用时重新读取 */
+void questionCacheInvalidate(void);
+
+/*
+ * 本进程添加题目 qid 后调用：缓存有效、qid 大于缓存中所有 qid 且不在显式事务中时直接追加到缓存，
+ * 返回它在集合中的下标；否则同 questionCacheInvalidate，返回 -1
+ */
+int questionCacheAdded(int qid, const char* word, const char* translate);
+
+/*
+ * 本进程删除题目 qid 后调用：条件同上时从缓存中移除，返回它原来的下标；
+ * 缓存中没有该题目时返回 -1 且缓存保持有效，无法直接修改时同 questionCacheInvalidate
+ */
+int questionCacheDeleted(int qid);
+
+/* 释放缓存的题库（关闭连接前由 dbClose 调用） */
+void questionCacheClear(void);
+
+void questionCacheGetStats(struct QuestionCacheStats* out);
+void questionCacheResetStats(void);
+
+#endif /* QUESTION_CACHE_H */
@@ -2,53 +2,29 @@
 #include <stdlib.h>
 #include <string.h>
 #include "question_list.h"
-#include "lib/sqlite3.h"
+#include "question_cache.h"
 
+/*
+ * 所有节点分配在同一块连续内存（slab）中，head 即 slab 的起始地址，
+ * next 指向数组中的下一个元素，遍历是顺序访问，释放只需一次 free
+ */
 struct QuestionNode* getQuestionsLL(int* count) {
-    sqlite3 *db;
-    if (sqlite3_open("vocab_system.db", &db) != SQLITE_OK) {
-        if (count) *count = 0;
-        return NULL;
-    }
+    const struct QuestionSet* set = questionCacheGet();
+    int n = set ? set->count : 0;
+    if (count) *count = 0;
+    if (n == 0) return NULL;
 
-    const char* sql = "SELECT qid, word, translate FROM questions ORDER BY qid ASC";
-    sqlite3_stmt* stmt = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        sqlite3_close(db);
-        if (count) *count = 0;
-        return NULL;
+    struct QuestionNode* nodes = (struct QuestionNode*)malloc(sizeof(struct QuestionNode) * n);
+    if (!nodes) return NULL;
+    for (int i = 0; i < n; i++) {
+        questionSetToQuestion(set, i, &nodes[i].q);
+        nodes[i].next = i + 1 < n ? &nodes[i + 1] : NULL;
     }
 
-    struct QuestionNode* head = NULL;
-    struct QuestionNode* tail = NULL;
-    int cnt = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        struct QuestionNode* node = (struct QuestionNode*)malloc(sizeof(struct QuestionNode));
-        if (!node) break;
-        memset(node, 0, sizeof(*node));
-        node->q.qid = sqlite3_column_int(stmt, 0);
-        const unsigned char* w = sqlite3_column_text(stmt, 1);
-        const unsigned char* t = sqlite3_column_text(stmt, 2);
-        if (w) strncpy(node->q.word, (const char*)w, MAX_WORD_LENGTH - 1);
-        if (t) strncpy(node->q.translate, (const char*)t, MAX_TRANS_LENGTH - 1);
-        node->next = NULL;
-
-        if (!head) head = tail = node;
-        else { tail->next = node; tail = node; }
-        cnt++;
-    }
-
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    if (count) *count = cnt;
-    return head;
+    if (count) *count = n;
+    return nodes;
 }
 
 void freeQuestionList(struct QuestionNode* head) {
-    struct QuestionNode* cur = head;
-    while (cur) {
-        struct QuestionNode* tmp = cur->next;
-        free(cur);
-        cur = tmp;
-    }
+    free(head);
 }
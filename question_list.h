@@ -12,10 +12,11 @@ struct QuestionNode {
 /*
  * 获取题目链表（按 qid 升序）
  * 返回链表头，count 输出题目数量（可为 NULL）
+ * 节点位于同一块连续内存中，仍可沿 next 遍历，但不能单独释放或插入节点
  */
 struct QuestionNode* getQuestionsLL(int* count);
 
-/* 释放题目链表 */
+/* 释放题目链表，head 必须是 getQuestionsLL 返回的链表头 */
 void freeQuestionList(struct QuestionNode* head);
 
 #endif /* QUESTION_LIST_H */
@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include <string.h>
+#include "question_set.h"
+
+void questionSetInit(struct QuestionSet* set) {
+    memset(set, 0, sizeof(*set));
+}
+
+/**
+ * @brief 确保 qid 与位置数组至少还能容纳一道题目
+ * @return 成功返回 1
+ */
+static int reserve_slots(struct QuestionSet* set) {
+    if (set->count < set->capacity) return 1;
+    int cap = set->capacity > 0 ? set->capacity * 2 : 256;
+    int* qids = (int*)realloc(set->qids, sizeof(int) * cap);
+    if (!qids) return 0;
+    set->qids = qids;
+    struct QuestionSpan* spans = (struct QuestionSpan*)realloc(set->spans, sizeof(struct QuestionSpan) * cap);
+    if (!spans) return 0;
+    set->spans = spans;
+    set->capacity = cap;
+    return 1;
+}
+
+/**
+ * @brief 确保 arena 至少还有 need 字节的空间
+ * @return 成功返回 1
+ */
+static int reserve_arena(struct QuestionSet* set, size_t need) {
+    if (set->arena_used + need <= set->arena_size) return 1;
+    size_t size = set->arena_size > 0 ? set->arena_size * 2 : 4096;
+    while (size < set->arena_used + need) size *= 2;
+    char* arena = (char*)realloc(set->arena, size);
+    if (!arena) return 0;
+    set->arena = arena;
+    set->arena_size = size;
+    return 1;
+}
+
+/**
+ * @brief 追加一道题目
+ * @return 成功返回 1；内存不足或字符串过长返回 0
+ */
+int questionSetAppend(struct QuestionSet* set, int qid, const char* word, size_t word_len,
+                      const char* translate, size_t translate_len) {
+    if (word_len > 0xFFFF || translate_len > 0xFFFF) return 0;
+    size_t need = word_len + translate_len + 2;
+    if (set->arena_used + need > 0xFFFFFFFFu) return 0;
+    if (!reserve_slots(set) || !reserve_arena(set, need)) return 0;
+    
+    struct QuestionSpan* span = &set->spans[set->count];
+    span->offset = (unsigned int)set->arena_used;
+    span->word_len = (unsigned short)word_len;
+    span->translate_len = (unsigned short)translate_len;
+    
+    char* p = set->arena + set->arena_used;
+    memcpy(p, word, word_len);
+    p[word_len] = '\0';
+    memcpy(p + word_len + 1, translate, translate_len);
+    p[word_len + 1 + translate_len] = '\0';
+    set->arena_used += need;
+    
+    set->qids[set->count++] = qid;
+    return 1;
+}
+
+/**
+ * @brief 只保留前 count 道题目，之后的字符串空间可被重新使用
+ */
+void questionSetTruncate(struct QuestionSet* set, int count) {
+    if (count < 0 || count >= set->count) return;
+    set->count = count;
+    set->arena_used = count > 0 ? set->spans[count].offset : 0;
+}
+
+/**
+ * @brief 删除第 i 道题目：只移动 qid 与位置数组，不整理 arena
+ */
+void questionSetRemove(struct QuestionSet* set, int i) {
+    if (i < 0 || i >= set->count) return;
+    memmove(set->qids + i, set->qids + i + 1, sizeof(int) * (set->count - i - 1));
+    memmove(set->spans + i, set->spans + i + 1, sizeof(struct QuestionSpan) * (set->count - i - 1));
+    set->count--;
+}
+
+/**
+ * @brief 释放追加时预留的多余空间，集合不再增长时调用
+ */
+void questionSetShrink(struct QuestionSet* set) {
+    if (set->count == 0) {
+        questionSetFree(set);
+        return;
+    }
+    int* qids = (int*)realloc(set->qids, sizeof(int) * set->count);
+    if (qids) set->qids = qids;
+    struct QuestionSpan* spans = (struct QuestionSpan*)realloc(set->spans, sizeof(struct QuestionSpan) * set->count);
+    if (spans) set->spans = spans;
+    if (qids && spans) set->capacity = set->count;
+    char* arena = (char*)realloc(set->arena, set->arena_used);
+    if (arena) {
+        set->arena = arena;
+        set->arena_size = set->arena_used;
+    }
+}
+
+void questionSetFree(struct QuestionSet* set) {
+    free(set->qids);
+    free(set->spans);
+    free(set->arena);
+    questionSetInit(set);
+}
+
+const char* questionSetWord(const struct QuestionSet* set, int i) {
+    return set->arena + set->spans[i].offset;
+}
+
+const char* questionSetTranslate(const struct QuestionSet* set, int i) {
+    return set->arena + set->spans[i].offset + set->spans[i].word_len + 1;
+}
+
+/**
+ * @brief 生成带下划线的单词提示，随机数来自 rand()（由 load_test_data.c 播种）
+ */
+void questionSetPuzzle(const struct QuestionSet* set, int i, char* out, int out_size) {
+    if (!set || !out || out_size <= 0) return;
+    const char* word = questionSetWord(set, i);
+    size_t len = set->spans[i].word_len;
+    if (len + 1 > (size_t)out_size) {
+        // 如果输出缓冲区太小，截断复制
+        strncpy(out, word, out_size - 1);
+        out[out_size - 1] = '\0';
+        return;
+    }
+    memcpy(out, word, len + 1);
+    if (len == 0) return;
+    if (len <= 3) {
+        /* 对短单词也随机替换一个字符为 '_' */
+        int idx = (int)(rand() % (int)len);
+        out[idx] = '_';
+        return;
+    }
+    /* 选择中间附近的一个字符替换为 '_'，避免替换首尾 */
+    int mid = (int)len / 2;
+    int shift = rand() % 3 - 1; // -1,0,1
+    int idx = mid + shift;
+    if (idx <= 0) idx = 1;
+    if (idx >= (int)len - 1) idx = (int)len - 2;
+    out[idx] = '_';
+}
+
+/**
+ * @brief 展开为 struct Question，超长的字符串按旧结构的长度截断，word_puzzled 置空
+ */
+void questionSetToQuestion(const struct QuestionSet* set, int i, struct Question* out) {
+    const struct QuestionSpan* span = &set->spans[i];
+    size_t w_len = span->word_len < MAX_WORD_LENGTH ? span->word_len : MAX_WORD_LENGTH - 1;
+    size_t t_len = span->translate_len < MAX_TRANS_LENGTH ? span->translate_len : MAX_TRANS_LENGTH - 1;
+    out->qid = set->qids[i];
+    memcpy(out->word, questionSetWord(set, i), w_len);
+    out->word[w_len] = '\0';
+    memcpy(out->translate, questionSetTranslate(set, i), t_len);
+    out->translate[t_len] = '\0';
+    out->word_puzzled[0] = '\0';
+}
+
+size_t questionSetBytes(const struct QuestionSet* set) {
+    return (size_t)set->capacity * (sizeof(int) + sizeof(struct QuestionSpan)) + set->arena_size;
+}
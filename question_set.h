@@ -0,0 +1,59 @@
+#ifndef QUESTION_SET_H
+#define QUESTION_SET_H
+
+#include <stddef.h>
+#include "database.h"
+
+/* 一道题目的字符串在 arena 中的位置：单词从 offset 开始，翻译紧随单词之后，均以 '\0' 结尾 */
+struct QuestionSpan {
+    unsigned int offset;
+    unsigned short word_len;
+    unsigned short translate_len;
+};
+
+/*
+ * 紧凑的题目集合：qid 数组、位置数组与一块连续的字符串 arena
+ * 每道题目只占 qid、位置与字符串本身的实际长度；word_puzzled 不再保存，需要时由 questionSetPuzzle 生成
+ */
+struct QuestionSet {
+    int count;
+    int capacity;
+    int* qids;
+    struct QuestionSpan* spans;
+    char* arena;
+    size_t arena_used;
+    size_t arena_size;
+};
+
+/* 初始化为空集合（不分配内存） */
+void questionSetInit(struct QuestionSet* set);
+
+/* 追加一道题目，字符串按给定长度复制，成功返回 1 */
+int questionSetAppend(struct QuestionSet* set, int qid, const char* word, size_t word_len,
+                      const char* translate, size_t translate_len);
+
+/* 只保留前 count 道题目（count 不大于当前题数） */
+void questionSetTruncate(struct QuestionSet* set, int count);
+
+/* 删除第 i 道题目，之后的题目前移一位；字符串留在 arena 中，直到集合被释放 */
+void questionSetRemove(struct QuestionSet* set, int i);
+
+/* 释放追加时预留的多余空间 */
+void questionSetShrink(struct QuestionSet* set);
+
+/* 释放集合占用的内存并重置为空集合 */
+void questionSetFree(struct QuestionSet* set);
+
+const char* questionSetWord(const struct QuestionSet* set, int i);
+const char* questionSetTranslate(const struct QuestionSet* set, int i);
+
+/* 为第 i 道题生成带下划线的单词提示，例如 "conversation" -> "conver_ation" */
+void questionSetPuzzle(const struct QuestionSet* set, int i, char* out, int out_size);
+
+/* 将第 i 道题展开为旧的 struct Question（供 getQuestions 兼容旧调用方） */
+void questionSetToQuestion(const struct QuestionSet* set, int i, struct Question* out);
+
+/* 集合占用的堆内存字节数 */
+size_t questionSetBytes(const struct QuestionSet* set);
+
+#endif /* QUESTION_SET_H */
@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "quiz_sample.h"
+#include "connection.h"
+#include "stmt_cache.h"
+#include "uuid.h"
+#include "lib/sqlite3.h"
+
+/* 主键探测的次数上限为 k 的倍数，超过后说明 qid 空洞过多，改用蓄水池抽样补足 */
+#define PROBES_PER_QUESTION 4
+
+/* 蓄水池中的候选题目，key 越大越优先保留 */
+struct Candidate {
+    double key;
+    int qid;
+};
+
+/* [0, 1) 区间的均匀分布 */
+static double next_uniform(void) {
+    return (uuidRandom64() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* [0, n) 区间的均匀整数 */
+static long long next_below(long long n) {
+    return (long long)(uuidRandom64() % (unsigned long long)n);
+}
+
+static int has_qid(const int* qids, int n, int qid) {
+    for (int i = 0; i < n; i++) {
+        if (qids[i] == qid) return 1;
+    }
+    return 0;
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 执行已绑定参数、返回 qid, word, translate 的单行查询，把结果追加到 out 并归还语句
+ * @return 追加成功返回 1，没有结果返回 0，出错返回 -1
+ */
+static int append_row(sqlite3_stmt* stmt, struct QuestionSet* out) {
+    int rc = sqlite3_step(stmt);
+    int result = 0;
+    if (rc == SQLITE_ROW) {
+        const char* w = (const char*)sqlite3_column_text(stmt, 1);
+        const char* t = (const char*)sqlite3_column_text(stmt, 2);
+        result = questionSetAppend(out, sqlite3_column_int(stmt, 0), w ? w : "", sqlite3_column_bytes(stmt, 1),
+                                   t ? t : "", sqlite3_column_bytes(stmt, 2)) ? 1 : -1;
+    } else if (rc != SQLITE_DONE) {
+        result = -1;
+    }
+    stmtRelease(stmt);
+    return result;
+}
+
+/**
+ * @brief 按 qid 读取一道题目并追加到 out
+ * @return 追加成功返回 1，题目不存在返回 0，出错返回 -1
+ */
+static int append_by_qid(struct QuestionSet* out, long long qid) {
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_BY_QID);
+    if (!stmt) return -1;
+    sqlite3_bind_int64(stmt, 1, qid);
+    return append_row(stmt, out);
+}
+
+/* 最小堆：堆顶为当前蓄水池中 key 最小的候选 */
+static void sift_down(struct Candidate* heap, int n, int i) {
+    for (;;) {
+        int smallest = i;
+        int l = 2 * i + 1, r = 2 * i + 2;
+        if (l < n && heap[l].key < heap[smallest].key) smallest = l;
+        if (r < n && heap[r].key < heap[smallest].key) smallest = r;
+        if (smallest == i) return;
+        struct Candidate tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void sift_up(struct Candidate* heap, int i) {
+    while (i > 0 && heap[(i - 1) / 2].key > heap[i].key) {
+        struct Candidate tmp = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+/**
+ * @brief 对游标做加权蓄水池抽样（Efraimidis-Spirakis），跳过 out 中已有的题目
+ * stmt 已绑定参数，第 0 列为 qid，加权时第 1 列为权重；函数返回前归还 stmt
+ * 每道题的 key 为 u^(1/w)，保留 key 最大的 k 道。w 为整数时 u^(1/w) 与 w 个均匀随机数的
+ * 最大值同分布，因此直接取最大值，不需要 pow。均匀抽样时 w 恒为 1
+ * @return 成功返回 1
+ */
+static int reservoir_sample(sqlite3_stmt* stmt, int k, int weighted, struct QuestionSet* out) {
+    if (!stmt) return 0;
+    struct Candidate* heap = (struct Candidate*)malloc(sizeof(struct Candidate) * k);
+    /* 已抽中的题目排序后二分查找，游标上的每一行只需 O(log k) 判断 */
+    int excluded_count = out->count;
+    int* excluded = (int*)malloc(sizeof(int) * (excluded_count > 0 ? excluded_count : 1));
+    if (!heap || !excluded) {
+        stmtRelease(stmt);
+        free(heap);
+        free(excluded);
+        return 0;
+    }
+    if (excluded_count > 0) {
+        memcpy(excluded, out->qids, sizeof(int) * excluded_count);
+        qsort(excluded, excluded_count, sizeof(int), compare_int);
+    }
+    int n = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int qid = sqlite3_column_int(stmt, 0);
+        if (excluded_count > 0 && bsearch(&qid, excluded, excluded_count, sizeof(int), compare_int)) continue;
+        int w = weighted ? sqlite3_column_int(stmt, 1) : 1;
+        if (w < 1) w = 1;
+        if (w > QUIZ_MAX_WEIGHT) w = QUIZ_MAX_WEIGHT;
+        double key = next_uniform();
+        for (int i = 1; i < w; i++) {
+            double u = next_uniform();
+            if (u > key) key = u;
+        }
+        
+        if (n < k) {
+            heap[n].key = key;
+            heap[n].qid = qid;
+            sift_up(heap, n++);
+        } else if (key > heap[0].key) {
+            heap[0].key = key;
+            heap[0].qid = qid;
+            sift_down(heap, n, 0);
+        }
+    }
+    stmtRelease(stmt);
+    
+    int ok = rc == SQLITE_DONE;
+    for (int i = 0; ok && i < n; i++) {
+        ok = append_by_qid(out, heap[i].qid) >= 0;
+    }
+    free(heap);
+    free(excluded);
+    return ok;
+}
+
+/**
+ * @brief 打开对候选题目做蓄水池抽样的游标：difficulty 为 0 时为整个题库，否则为该难度的索引范围
+ */
+static sqlite3_stmt* candidates(int difficulty) {
+    if (difficulty == 0) return stmtGet(STMT_QUESTION_WEIGHTS);
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_IN_BUCKET);
+    if (stmt) sqlite3_bind_int(stmt, 1, difficulty);
+    return stmt;
+}
+
+/**
+ * @brief 均匀抽样：在 [MIN(qid), MAX(qid)] 中随机探测主键，命中且未抽过的题目即被选中
+ * difficulty 不为 0 时只接受该难度的题目（拒绝采样）
+ * 每次命中在现存（该难度的）题目中等概率，因此结果是均匀的不放回抽样；
+ * 探测次数用尽说明 qid 空洞过多或该难度的题目很少，此时由蓄水池抽样补足
+ * @return 成功返回 1
+ */
+static int probe_sample(int difficulty, int k, struct QuestionSet* out) {
+    sqlite3_stmt* stmt = stmtGet(STMT_QUESTION_QID_RANGE);
+    if (!stmt) return 0;
+    if (sqlite3_step(stmt) != SQLITE_ROW || sqlite3_column_type(stmt, 0) == SQLITE_NULL) {
+        stmtRelease(stmt);
+        return 1;   /* 题库为空 */
+    }
+    long long min_qid = sqlite3_column_int64(stmt, 0);
+    long long span = sqlite3_column_int64(stmt, 1) - min_qid + 1;
+    stmtRelease(stmt);
+    
+    int target = out->count + k;
+    if (span < k) return reservoir_sample(candidates(difficulty), k, 0, out);
+    /* 各难度的题目约占 1 / DIFFICULTY_LEVELS，按难度抽取时相应增加探测次数 */
+    int probes = k * PROBES_PER_QUESTION * (difficulty ? DIFFICULTY_LEVELS : 1);
+    for (; probes > 0 && out->count < target; probes--) {
+        long long qid = min_qid + next_below(span);
+        if (has_qid(out->qids, out->count, (int)qid)) continue;
+        if (difficulty == 0) {
+            if (append_by_qid(out, qid) < 0) return 0;
+            continue;
+        }
+        stmt = stmtGet(STMT_QUESTION_BY_QID_DIFFICULTY);
+        if (!stmt) return 0;
+        sqlite3_bind_int64(stmt, 1, qid);
+        sqlite3_bind_int(stmt, 2, difficulty);
+        if (append_row(stmt, out) < 0) return 0;
+    }
+    return out->count < target ? reservoir_sample(candidates(difficulty), target - out->count, 0, out) : 1;
+}
+
+/**
+ * @brief 打乱 set 中从 from 开始的题目顺序（Fisher-Yates），只交换 qid 与位置，字符串不动
+ */
+static void shuffle(struct QuestionSet* set, int from) {
+    for (int i = set->count - 1; i > from; i--) {
+        int j = from + (int)next_below(i - from + 1);
+        int qid = set->qids[i];
+        set->qids[i] = set->qids[j];
+        set->qids[j] = qid;
+        struct QuestionSpan span = set->spans[i];
+        set->spans[i] = set->spans[j];
+        set->spans[j] = span;
+    }
+}
+
+/**
+ * @brief 按难度比例组卷
+ * @return 追加的题数，出错返回 -1
+ */
+int sampleByDifficultyMix(const int percent[DIFFICULTY_LEVELS], int k, struct QuestionSet* out) {
+    if (!dbGet() || !out || !percent) return -1;
+    if (k <= 0) return 0;
+    
+    /* 最大余数法：先按比例向下取整，剩余的题数依次分给余数最大的难度 */
+    int total = 0;
+    for (int i = 0; i < DIFFICULTY_LEVELS; i++) total += percent[i] > 0 ? percent[i] : 0;
+    int counts[DIFFICULTY_LEVELS] = {0};
+    int remainder[DIFFICULTY_LEVELS] = {0};
+    int assigned = 0;
+    for (int i = 0; total > 0 && i < DIFFICULTY_LEVELS; i++) {
+        long long share = (long long)k * (percent[i] > 0 ? percent[i] : 0);
+        counts[i] = (int)(share / total);
+        remainder[i] = (int)(share % total);
+        assigned += counts[i];
+    }
+    while (total > 0 && assigned < k) {
+        int best = 0;
+        for (int i = 1; i < DIFFICULTY_LEVELS; i++) {
+            if (remainder[i] > remainder[best]) best = i;
+        }
+        counts[best]++;
+        remainder[best] = -1;
+        assigned++;
+    }
+    
+    int before = out->count;
+    int ok = 1;
+    for (int i = 0; ok && i < DIFFICULTY_LEVELS; i++) {
+        if (counts[i] > 0) ok = probe_sample(i + 1, counts[i], out);
+    }
+    if (ok && out->count - before < k) ok = probe_sample(0, k - (out->count - before), out);
+    if (!ok) {
+        fprintf(stderr, "[ERROR] Sample questions failed: %s\n", sqlite3_errmsg(dbGet()));
+        return -1;
+    }
+    shuffle(out, before);
+    return out->count - before;
+}
+
+/**
+ * @brief 从题库中随机抽取 k 道题目
+ * @return 抽到的题数，出错返回 -1
+ */
+int sampleQuestions(int k, enum QuizSampling sampling, struct QuestionSet* out) {
+    if (!dbGet() || !out) return -1;
+    if (k <= 0) return 0;
+    
+    int before = out->count;
+    int ok = sampling == QUIZ_SAMPLE_WEIGHTED ? reservoir_sample(stmtGet(STMT_QUESTION_WEIGHTS), k, 1, out)
+                                              : probe_sample(0, k, out);
+    if (!ok) {
+        fprintf(stderr, "[ERROR] Sample questions failed: %s\n", sqlite3_errmsg(dbGet()));
+        return -1;
+    }
+    shuffle(out, before);
+    return out->count - before;
+}
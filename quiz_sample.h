@@ -0,0 +1,50 @@
+#ifndef QUIZ_SAMPLE_H
+#define QUIZ_SAMPLE_H
+
+#include "question_set.h"
+
+/* 未指定题目数量时每次测验抽取的题数 */
+#define QUIZ_DEFAULT_SIZE 20
+
+/* 加权抽样时单道题目的最大权重（questions.difficulty 超出时按此值计） */
+#define QUIZ_MAX_WEIGHT 16
+
+/* 题目难度分为 1 到 DIFFICULTY_LEVELS 级，由 recomputeDifficulty 按答错率重新计算 */
+#define DIFFICULTY_LEVELS 5
+
+/* 重新计算难度时，答题次数少于此值的题目保持原难度 */
+#define DIFFICULTY_MIN_ANSWERS 5
+
+/* 抽题方式 */
+enum QuizSampling {
+    QUIZ_SAMPLE_UNIFORM,    /* 每道题被抽中的概率相同 */
+    QUIZ_SAMPLE_WEIGHTED,   /* 按 questions.difficulty 加权，难题更容易被抽中 */
+    QUIZ_SAMPLE_REVIEW,     /* 先出该学生已到期的复习单词（见 review.h），不足部分均匀抽取 */
+    QUIZ_SAMPLE_MIX         /* 按 QuizOptions.mix 指定的难度比例组卷 */
+};
+
+/* 测验选项，startQuizWithOptions 传 NULL 时使用 QUIZ_DEFAULT_SIZE 与均匀抽样 */
+struct QuizOptions {
+    int size;                       /* 题目数量，<= 0 时使用 QUIZ_DEFAULT_SIZE */
+    enum QuizSampling sampling;
+    int mix[DIFFICULTY_LEVELS];     /* QUIZ_SAMPLE_MIX 时难度 1 到 DIFFICULTY_LEVELS 各占的百分比 */
+};
+
+/*
+ * 从题库中不放回地随机抽取 k 道题目，按随机顺序追加到 out（需已初始化），out 中已有的题目不会重复抽取
+ * QUIZ_SAMPLE_REVIEW 需要知道学生，由 startQuizWithOptions 处理，这里按均匀抽样处理
+ * 均匀抽样按 qid 随机探测主键，题库存在大量空洞时改为对游标做蓄水池抽样；
+ * 加权抽样对游标做加权蓄水池抽样。只在内存中保留 k 道题目
+ * 返回抽到的题数（题库不足 k 道时为全部题目），出错返回 -1
+ */
+int sampleQuestions(int k, enum QuizSampling sampling, struct QuestionSet* out);
+
+/*
+ * 按难度比例组卷：percent[i] 为难度 i + 1 所占的百分比，按最大余数法换算成各难度的题数
+ * 每个难度按 qid 随机探测主键、只接受该难度的题目，题目较少的难度改为扫描 idx_questions_difficulty；
+ * 某个难度的题目不足时由其他题目均匀补足。题目按随机顺序追加到 out
+ * 返回追加的题数，出错返回 -1
+ */
+int sampleByDifficultyMix(const int percent[DIFFICULTY_LEVELS], int k, struct QuestionSet* out);
+
+#endif /* QUIZ_SAMPLE_H */
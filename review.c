@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include "review.h"
+#include "connection.h"
+#include "stmt_cache.h"
+#include "uuid.h"
+#include "lib/sqlite3.h"
+
+/**
+ * @brief 取出已到期的复习单词
+ * @return 追加的题数，出错返回 -1
+ */
+int reviewDueQuestions(const char* student_uuid, long long now, int limit, struct QuestionSet* out) {
+    if (!student_uuid || !out) return -1;
+    if (limit <= 0) return 0;
+    
+    sqlite3_stmt* stmt = stmtGet(STMT_REVIEW_DUE);
+    if (!stmt) return -1;
+    uuidBind(stmt, 1, student_uuid);
+    sqlite3_bind_int64(stmt, 2, now);
+    sqlite3_bind_int(stmt, 3, limit);
+    
+    int added = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* w = (const char*)sqlite3_column_text(stmt, 1);
+        const char* t = (const char*)sqlite3_column_text(stmt, 2);
+        if (!questionSetAppend(out, sqlite3_column_int(stmt, 0), w ? w : "", sqlite3_column_bytes(stmt, 1),
+                               t ? t : "", sqlite3_column_bytes(stmt, 2))) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        added++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "[ERROR] Query due reviews failed: %s\n", sqlite3_errmsg(dbGet()));
+        added = -1;
+    }
+    stmtRelease(stmt);
+    return added;
+}
@@ -0,0 +1,19 @@
+#ifndef REVIEW_H
+#define REVIEW_H
+
+#include "question_set.h"
+
+/*
+ * 间隔重复（SM-2）调度：复习状态保存在 review_state 表中（见 migrate.c 的迁移 4），
+ * 由 answer_records 上的触发器在每条答题记录写入时更新，因此 startQuiz 记录答案即完成调度
+ * due_at 为 Unix 时间（秒）
+ */
+
+/*
+ * 取出学生在 now 时刻已到期的单词，按到期时间从早到晚最多 limit 个，追加到 out
+ * 只扫描 idx_review_due 中该学生已到期的部分
+ * 返回追加的题数，出错返回 -1
+ */
+int reviewDueQuestions(const char* student_uuid, long long now, int limit, struct QuestionSet* out);
+
+#endif /* REVIEW_H */
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "roster.h"
+
+/* 每行最多的字段数：用户名、密码、等级、班级、学号、教师 UUID */
+#define ROSTER_FIELDS 6
+
+/**
+ * @brief 把一行按逗号原地切分为字段，去掉未加引号字段首尾的空白，并还原引号中的 ""
+ * @return 字段数，多于 max 时仍返回实际的个数，fields 只保存前 max 个
+ */
+static int split_fields(char* p, char** fields, int max) {
+    int n = 0;
+    for (;;) {
+        while (*p == ' ' || *p == '\t') p++;
+        char* start = p;
+        char* out = p;
+        if (*p == '"') {
+            p++;
+            while (*p) {
+                if (*p == '"') {
+                    if (p[1] != '"') {
+                        p++;
+                        break;
+                    }
+                    p++;
+                }
+                *out++ = *p++;
+            }
+            /* 结尾引号与逗号之间的内容被忽略 */
+            while (*p && *p != ',') p++;
+        } else {
+            while (*p && *p != ',') p++;
+            out = p;
+            while (out > start && (out[-1] == ' ' || out[-1] == '\t')) out--;
+        }
+        char sep = *p;
+        *out = '\0';
+        if (n < max) fields[n] = start;
+        n++;
+        if (!sep) return n;
+        p++;
+    }
+}
+
+/**
+ * @brief 解析整数字段，空串取 empty_value
+ * @return 格式正确返回 1
+ */
+static int parse_int(const char* s, int empty_value, int* out) {
+    if (!s[0]) {
+        *out = empty_value;
+        return 1;
+    }
+    char* end;
+    long v = strtol(s, &end, 10);
+    if (*end || v < -2147483647L || v > 2147483647L) return 0;
+    *out = (int)v;
+    return 1;
+}
+
+/**
+ * @brief 读入整个文件，末尾补 '\0'
+ */
+static char* read_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    char* text = NULL;
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+    if (size >= 0 && fseek(f, 0, SEEK_SET) == 0) text = (char*)malloc(size + 1);
+    if (text && fread(text, 1, size, f) != (size_t)size) {
+        free(text);
+        text = NULL;
+    }
+    if (text) text[size] = '\0';
+    fclose(f);
+    return text;
+}
+
+int rosterLoad(const char* path, struct Roster* roster) {
+    memset(roster, 0, sizeof(*roster));
+    roster->text = read_file(path);
+    if (!roster->text) {
+        fprintf(stderr, "[ERROR] Cannot open roster file: %s\n", path);
+        return 0;
+    }
+
+    int max_rows = 1;
+    for (const char* c = roster->text; *c; c++) {
+        if (*c == '\n') max_rows++;
+    }
+    roster->entries = (struct RosterEntry*)calloc(max_rows, sizeof(struct RosterEntry));
+    roster->lines = (int*)malloc(sizeof(int) * max_rows);
+    if (!roster->entries || !roster->lines) {
+        rosterFree(roster);
+        return 0;
+    }
+
+    char* p = roster->text;
+    /* 跳过 UTF-8 BOM */
+    if (strncmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+    int line_no = 0;
+    int header_checked = 0;
+    while (*p) {
+        char* line = p;
+        char* nl = strchr(p, '\n');
+        p = nl ? nl + 1 : line + strlen(line);
+        if (nl) *nl = '\0';
+        size_t len = strlen(line);
+        while (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+        line_no++;
+        if (len == 0 || line[0] == '#') continue;
+
+        char* fields[ROSTER_FIELDS];
+        int n = split_fields(line, fields, ROSTER_FIELDS);
+        if (!header_checked) {
+            header_checked = 1;
+            if (strcmp(fields[0], "username") == 0 || strcmp(fields[0], "用户名") == 0) continue;
+        }
+
+        struct RosterEntry* e = &roster->entries[roster->count];
+        roster->lines[roster->count++] = line_no;
+        e->username = fields[0];
+        e->level = 2;
+        if (n < ROSTER_FIELDS - 1 || n > ROSTER_FIELDS) continue;
+        e->class_name = fields[3];
+        e->teacher_uuid = n == ROSTER_FIELDS ? fields[5] : NULL;
+        /* 无法解析的行不填写密码，由 createUsersBulk 判为 ROSTER_INVALID */
+        if (parse_int(fields[2], 2, &e->level) && parse_int(fields[4], 0, &e->student_num)) {
+            e->password = fields[1];
+        }
+    }
+    return 1;
+}
+
+void rosterFree(struct Roster* roster) {
+    free(roster->entries);
+    free(roster->lines);
+    free(roster->text);
+    memset(roster, 0, sizeof(*roster));
+}
+
+int rosterImport(const char* path) {
+    struct Roster roster;
+    if (!rosterLoad(path, &roster)) return -1;
+
+    int created = createUsersBulk(roster.entries, roster.count);
+    if (created < 0) {
+        fprintf(stderr, "[ERROR] Roster import failed, no users were created\n");
+        rosterFree(&roster);
+        return -1;
+    }
+
+    int duplicate = 0, invalid = 0;
+    for (int i = 0; i < roster.count; i++) {
+        const struct RosterEntry* e = &roster.entries[i];
+        if (e->status == ROSTER_DUPLICATE) {
+            fprintf(stderr, "[WARN] Line %d: username already exists: %s\n", roster.lines[i], e->username);
+            duplicate++;
+        } else if (e->status == ROSTER_INVALID) {
+            fprintf(stderr, "[WARN] Line %d: invalid row\n", roster.lines[i]);
+            invalid++;
+        }
+    }
+    printf("[SUCCESS] Roster imported: %d users created, %d duplicate, %d invalid\n", created, duplicate, invalid);
+    rosterFree(&roster);
+    return created;
+}
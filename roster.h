@@ -0,0 +1,32 @@
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include "database.h"
+
+/*
+ * 读取 CSV 格式的学生名单并批量创建用户（见 createUsersBulk）
+ * 每行为 用户名,密码,等级,班级,学号[,教师 UUID]，等级只能为 2 或留空，其他等级的行按格式错误报告；
+ * 字段可用双引号包围（其中的 "" 表示一个双引号），不支持跨行的字段。
+ * 空行、以 # 开头的行与第一列为 username 的表头行被忽略
+ */
+
+/* 读入内存的名单，entries 中的字符串都指向 text */
+struct Roster {
+    struct RosterEntry* entries;
+    int* lines;     /* 每行在文件中的行号，从 1 开始 */
+    int count;
+    char* text;
+};
+
+/* 读取名单文件到 roster，字段数不对或学号、等级不是整数的行按 ROSTER_INVALID 保留，成功返回 1 */
+int rosterLoad(const char* path, struct Roster* roster);
+
+void rosterFree(struct Roster* roster);
+
+/*
+ * 读取名单并在一个事务内创建全部用户，逐行报告未创建的用户并输出汇总
+ * 返回创建的用户数，文件无法读取或事务失败时返回 -1
+ */
+int rosterImport(const char* path);
+
+#endif /* ROSTER_H */
@@ -0,0 +1,465 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "search.h"
+#include "dict.h"
+#include "question_cache.h"
+
+/* 倒排表中每一项为 (n-gram << ENTRY_BITS) | 条目号，条目号不超过 2^22 */
+#define ENTRY_BITS 22
+#define MAX_ENTRIES (1 << ENTRY_BITS)
+
+/*
+ * n-gram 按字节而不按字符切分：按 UTF-8 切分 GBK 文本会把前一个汉字的尾字节与后一个汉字连在一起，
+ * 关键字与包含它的文本切出的 n-gram 就不一致。单字节为字节本身，两字节为 256 + b1 * 256 + b2
+ */
+#define GRAM_BITS 17
+
+/* 翻译中的 n-gram 加上此标记，与单词中的分开 */
+#define FIELD_TRANSLATE (1ull << GRAM_BITS)
+
+/* 关键字在栈上的缓冲区大小，更长的关键字在堆上分配 */
+#define QUERY_STACK 256
+
+struct SearchIndex {
+    int built;
+    long long generation;           /* 建立索引时题库缓存的版本 */
+    const struct QuestionSet* set;  /* 题库索引直接引用题库缓存，词库索引引用 own */
+    struct QuestionSet own;
+    int* order;                     /* 条目号到 set 下标：按小写单词排序 */
+    uint64_t* grams;                /* 升序且无重复 */
+    size_t gram_count;
+};
+
+static struct SearchIndex indexes[2];
+
+static unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+/* 忽略 ASCII 大小写比较两个字符串 */
+static int fold_compare(const char* a, const char* b) {
+    const unsigned char* x = (const unsigned char*)a;
+    const unsigned char* y = (const unsigned char*)b;
+    while (*x && fold(*x) == fold(*y)) {
+        x++;
+        y++;
+    }
+    return (int)fold(*x) - (int)fold(*y);
+}
+
+/* s 是否以 prefix（已转为小写）开头 */
+static int fold_starts_with(const char* s, const char* prefix, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (fold((unsigned char)s[i]) != (unsigned char)prefix[i]) return 0;
+    }
+    return 1;
+}
+
+/* s 是否包含 needle（已转为小写） */
+static int fold_contains(const char* s, const char* needle, size_t len) {
+    for (; *s; s++) {
+        if (fold_starts_with(s, needle, len)) return 1;
+    }
+    return len == 0;
+}
+
+/* 相邻两字节 a、b（已转为小写）的 n-gram */
+static uint64_t pair_gram(unsigned char a, unsigned char b) {
+    return 256 + ((uint64_t)a << 8) + b;
+}
+
+/**
+ * @brief 把字符串 s 的单字节与相邻两字节 n-gram 写入 out，返回写入的个数（不超过 2 * 字节数）
+ */
+static size_t emit_grams(const char* s, uint64_t field, uint64_t entry, uint64_t* out) {
+    const unsigned char* p = (const unsigned char*)s;
+    size_t n = 0;
+    for (size_t i = 0; p[i]; i++) {
+        out[n++] = ((fold(p[i]) | field) << ENTRY_BITS) | entry;
+        if (i > 0) out[n++] = ((pair_gram(fold(p[i - 1]), fold(p[i])) | field) << ENTRY_BITS) | entry;
+    }
+    return n;
+}
+
+/* 基数排序每趟处理的位数：两趟覆盖 n-gram 所在的 18 位 */
+#define RADIX_BITS 9
+
+/**
+ * @brief 按 n-gram 做稳定的基数排序；条目号按递增顺序写入，不需要参与排序
+ * @return 排好序的数组（a 或 tmp 之一）
+ */
+static uint64_t* radix_sort(uint64_t* a, uint64_t* tmp, size_t n) {
+    static size_t counts[1 << RADIX_BITS];
+    if (n == 0) return a;
+    for (int shift = ENTRY_BITS; shift < ENTRY_BITS + GRAM_BITS + 1; shift += RADIX_BITS) {
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) counts[(a[i] >> shift) & ((1 << RADIX_BITS) - 1)]++;
+        /* 这一趟所有项的数字相同时不需要移动 */
+        if (counts[(a[0] >> shift) & ((1 << RADIX_BITS) - 1)] == n) continue;
+        size_t sum = 0;
+        for (size_t d = 0; d < (1 << RADIX_BITS); d++) {
+            size_t c = counts[d];
+            counts[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) tmp[counts[(a[i] >> shift) & ((1 << RADIX_BITS) - 1)]++] = a[i];
+        uint64_t* t = a; a = tmp; tmp = t;
+    }
+    return a;
+}
+
+struct SortItem {
+    const char* word;
+    int index;
+};
+
+static int compare_items(const void* a, const void* b) {
+    const struct SortItem* x = (const struct SortItem*)a;
+    const struct SortItem* y = (const struct SortItem*)b;
+    int c = fold_compare(x->word, y->word);
+    return c ? c : (x->index > y->index) - (x->index < y->index);
+}
+
+static void index_free(struct SearchIndex* ix) {
+    free(ix->order);
+    free(ix->grams);
+    questionSetFree(&ix->own);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/**
+ * @brief 为 set 建立单词顺序与倒排表，替换 ix 中原有的索引（own 保持不变）
+ * @return 成功返回 1
+ */
+static int build_index(struct SearchIndex* ix, const struct QuestionSet* set) {
+    int n = set->count;
+    if (n >= MAX_ENTRIES) {
+        fprintf(stderr, "[ERROR] Too many entries to index: %d\n", n);
+        return 0;
+    }
+    struct SortItem* items = (struct SortItem*)malloc(sizeof(struct SortItem) * (n ? n : 1));
+    int* order = (int*)malloc(sizeof(int) * (n ? n : 1));
+    size_t bound = 0;
+    for (int i = 0; i < n; i++) bound += 2 * (set->spans[i].word_len + set->spans[i].translate_len);
+    uint64_t* grams = (uint64_t*)malloc(sizeof(uint64_t) * (bound ? bound : 1));
+    uint64_t* tmp = (uint64_t*)malloc(sizeof(uint64_t) * (bound ? bound : 1));
+    if (!items || !order || !grams || !tmp) {
+        free(items); free(order); free(grams); free(tmp);
+        fprintf(stderr, "[ERROR] Build search index failed: out of memory\n");
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        items[i].word = questionSetWord(set, i);
+        items[i].index = i;
+    }
+    qsort(items, n, sizeof(struct SortItem), compare_items);
+    size_t count = 0;
+    for (int e = 0; e < n; e++) {
+        int i = items[e].index;
+        order[e] = i;
+        count += emit_grams(questionSetWord(set, i), 0, (uint64_t)e, grams + count);
+        count += emit_grams(questionSetTranslate(set, i), FIELD_TRANSLATE, (uint64_t)e, grams + count);
+    }
+    free(items);
+
+    uint64_t* sorted = radix_sort(grams, tmp, count);
+    free(sorted == grams ? tmp : grams);
+    grams = sorted;
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || grams[i] != grams[unique - 1]) grams[unique++] = grams[i];
+    }
+    uint64_t* shrunk = (uint64_t*)realloc(grams, sizeof(uint64_t) * (unique ? unique : 1));
+    if (shrunk) grams = shrunk;
+
+    free(ix->order);
+    free(ix->grams);
+    ix->set = set;
+    ix->order = order;
+    ix->grams = grams;
+    ix->gram_count = unique;
+    ix->built = 1;
+    return 1;
+}
+
+static int append_dict_word(const char* word, const char* translate, void* ctx) {
+    struct QuestionSet* set = (struct QuestionSet*)ctx;
+    if (!word) return 0;
+    if (!translate) translate = "";
+    return !questionSetAppend(set, 0, word, strlen(word), translate, strlen(translate));
+}
+
+/**
+ * @brief 取得 source 的最新索引：题库变化后重建，词库第一次使用时读取
+ * @return 出错返回 NULL
+ */
+static struct SearchIndex* current_index(enum SearchSource source) {
+    struct SearchIndex* ix = &indexes[source == SEARCH_DICT];
+    if (source == SEARCH_DICT) {
+        if (ix->built) return ix;
+        if (!dictOpen(DICT_NAME)) return NULL;
+        struct QuestionSet words;
+        questionSetInit(&words);
+        if (dictForEach(NULL, append_dict_word, &words) < 0) {
+            questionSetFree(&words);
+            return NULL;
+        }
+        questionSetShrink(&words);
+        index_free(ix);
+        ix->own = words;
+        return build_index(ix, &ix->own) ? ix : NULL;
+    }
+
+    const struct QuestionSet* set = questionCacheGet();
+    if (!set) return NULL;
+    long long generation = questionCacheGeneration();
+    if (ix->built && ix->generation == generation) return ix;
+    if (!build_index(ix, set)) {
+        ix->built = 0;  /* 旧索引引用的题库已被替换 */
+        return NULL;
+    }
+    ix->generation = generation;
+    return ix;
+}
+
+/**
+ * @brief 倒排表中 key 对应的区间 [*lo, *hi)
+ */
+static void gram_range(const struct SearchIndex* ix, uint64_t key, size_t* lo, size_t* hi) {
+    uint64_t bounds[2] = {key << ENTRY_BITS, (key + 1) << ENTRY_BITS};
+    size_t result[2];
+    for (int b = 0; b < 2; b++) {
+        size_t l = 0, h = ix->gram_count;
+        while (l < h) {
+            size_t mid = l + (h - l) / 2;
+            if (ix->grams[mid] < bounds[b]) l = mid + 1;
+            else h = mid;
+        }
+        result[b] = l;
+    }
+    *lo = result[0];
+    *hi = result[1];
+}
+
+static int append_entry(const struct SearchIndex* ix, int entry, struct QuestionSet* out) {
+    const struct QuestionSet* set = ix->set;
+    int i = ix->order[entry];
+    return questionSetAppend(out, set->qids[i], questionSetWord(set, i), set->spans[i].word_len,
+                             questionSetTranslate(set, i), set->spans[i].translate_len);
+}
+
+/**
+ * @brief 前缀查找：在按小写单词排序的条目中二分定位第一个不小于 query 的单词
+ */
+static int search_prefix(const struct SearchIndex* ix, const char* query, size_t len, int limit, struct QuestionSet* out) {
+    const struct QuestionSet* set = ix->set;
+    int l = 0, h = set->count;
+    while (l < h) {
+        int mid = l + (h - l) / 2;
+        if (fold_compare(questionSetWord(set, ix->order[mid]), query) < 0) l = mid + 1;
+        else h = mid;
+    }
+    int found = 0;
+    for (int e = l; e < set->count && (limit <= 0 || found < limit); e++) {
+        if (!fold_starts_with(questionSetWord(set, ix->order[e]), query, len)) break;
+        if (!append_entry(ix, e, out)) return -1;
+        found++;
+    }
+    return found;
+}
+
+/**
+ * @brief 子串查找：取 query 中倒排表最短的 n-gram（只有一个字节时为单字节，否则为相邻两字节），逐条核对
+ */
+static int search_substring(const struct SearchIndex* ix, const char* query, size_t len, int translate,
+                            int limit, struct QuestionSet* out) {
+    const struct QuestionSet* set = ix->set;
+    const unsigned char* q = (const unsigned char*)query;
+    uint64_t field = translate ? FIELD_TRANSLATE : 0;
+    size_t lo = 0, hi = 0;
+    /* 多于一个字节时只用两字节 n-gram：它们的倒排表不会比其中单字节的更长 */
+    for (size_t i = len == 1 ? 0 : 1; i < len; i++) {
+        uint64_t key = len == 1 ? q[0] : pair_gram(q[i - 1], q[i]);
+        size_t l, h;
+        gram_range(ix, key | field, &l, &h);
+        if (i <= 1 || h - l < hi - lo) {
+            lo = l;
+            hi = h;
+        }
+        if (lo == hi) return 0;
+    }
+
+    int found = 0;
+    if (len == 0) {
+        /* 空关键字匹配所有条目 */
+        for (int e = 0; e < set->count && (limit <= 0 || found < limit); e++) {
+            if (!append_entry(ix, e, out)) return -1;
+            found++;
+        }
+        return found;
+    }
+    for (size_t g = lo; g < hi && (limit <= 0 || found < limit); g++) {
+        int e = (int)(ix->grams[g] & (MAX_ENTRIES - 1));
+        int i = ix->order[e];
+        const char* text = translate ? questionSetTranslate(set, i) : questionSetWord(set, i);
+        if (!fold_contains(text, query, len)) continue;
+        if (!append_entry(ix, e, out)) return -1;
+        found++;
+    }
+    return found;
+}
+
+/**
+ * @brief 搜索单词，必要时先建立或重建索引
+ * @param query 关键字，ASCII 字母不区分大小写
+ * @param limit 最多返回的个数，<= 0 表示不限
+ * @return 追加到 out 的个数，出错返回 -1
+ */
+int searchWords(enum SearchSource source, enum SearchMode mode, const char* query, int limit, struct QuestionSet* out) {
+    struct SearchIndex* ix = current_index(source);
+    if (!ix) return -1;
+
+    size_t len = strlen(query);
+    char stack_query[QUERY_STACK];
+    char* folded = len < QUERY_STACK ? stack_query : (char*)malloc(len + 1);
+    if (!folded) return -1;
+    for (size_t i = 0; i <= len; i++) folded[i] = (char)fold((unsigned char)query[i]);
+
+    int found = mode == SEARCH_PREFIX ? search_prefix(ix, folded, len, limit, out)
+                                      : search_substring(ix, folded, len, mode == SEARCH_TRANSLATION, limit, out);
+    if (folded != stack_query) free(folded);
+    return found;
+}
+
+int searchBuild(enum SearchSource source) {
+    return current_index(source) != NULL;
+}
+
+static int compare_grams(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 题库索引是否正好落后缓存一次修改，是则可以只更新被修改的条目
+ */
+static struct SearchIndex* patchable_index(int i) {
+    struct SearchIndex* ix = &indexes[0];
+    if (i < 0 || !ix->built) return NULL;
+    if (ix->generation != questionCacheGeneration() - 1) return NULL;
+    return ix;
+}
+
+/**
+ * @brief 插入缓存末尾新增的第 i 道题目：按单词找到它的条目号 e，之后的条目号加 1，
+ * 再把它的 n-gram 从后往前归并进倒排表，不需要重新排序
+ */
+void searchQuestionAdded(int i) {
+    struct SearchIndex* ix = patchable_index(i);
+    if (!ix) return;
+    const struct QuestionSet* set = ix->set;
+    int n = set->count;     /* 已包含新题目 */
+    ix->built = 0;          /* 中途失败时下一次搜索重建 */
+    if (n >= MAX_ENTRIES) return;
+
+    const char* word = questionSetWord(set, i);
+    int l = 0, h = n - 1;
+    while (l < h) {
+        int mid = l + (h - l) / 2;
+        /* 与 compare_items 一致：单词相同时下标大的在后，新题目的下标最大 */
+        if (fold_compare(questionSetWord(set, ix->order[mid]), word) <= 0) l = mid + 1;
+        else h = mid;
+    }
+    int e = l;
+
+    size_t bound = 2 * (set->spans[i].word_len + set->spans[i].translate_len);
+    uint64_t* added = (uint64_t*)malloc(sizeof(uint64_t) * (bound ? bound : 1));
+    int* order = (int*)realloc(ix->order, sizeof(int) * n);
+    if (order) ix->order = order;
+    uint64_t* grams = added ? (uint64_t*)realloc(ix->grams, sizeof(uint64_t) * (ix->gram_count + bound + 1)) : NULL;
+    if (grams) ix->grams = grams;
+    if (!added || !order || !grams) {
+        free(added);
+        return;
+    }
+
+    memmove(order + e + 1, order + e, sizeof(int) * (n - 1 - e));
+    order[e] = i;
+
+    size_t m = emit_grams(word, 0, (uint64_t)e, added);
+    m += emit_grams(questionSetTranslate(set, i), FIELD_TRANSLATE, (uint64_t)e, added + m);
+    qsort(added, m, sizeof(uint64_t), compare_grams);
+    size_t unique = 0;
+    for (size_t k = 0; k < m; k++) {
+        if (unique == 0 || added[k] != added[unique - 1]) added[unique++] = added[k];
+    }
+
+    /* 原有项的条目号不小于 e 的加 1 后仍保持升序，且不会与新条目的项相同 */
+    size_t r = ix->gram_count, k = unique, w = ix->gram_count + unique;
+    while (k > 0) {
+        uint64_t old = 0;
+        if (r > 0) {
+            old = grams[r - 1];
+            if ((int)(old & (MAX_ENTRIES - 1)) >= e) old++;
+        }
+        if (r > 0 && old > added[k - 1]) {
+            grams[--w] = old;
+            r--;
+        } else {
+            grams[--w] = added[--k];
+        }
+    }
+    for (size_t g = 0; g < r; g++) {
+        if ((int)(grams[g] & (MAX_ENTRIES - 1)) >= e) grams[g]++;
+    }
+    free(added);
+    ix->gram_count += unique;
+    ix->generation = questionCacheGeneration();
+    ix->built = 1;
+}
+
+/**
+ * @brief 删除原下标为 i 的题目：去掉它的条目与 n-gram，之后的条目号减 1，
+ * 条目中大于 i 的下标减 1 以对应前移后的题库缓存
+ */
+void searchQuestionRemoved(int i) {
+    struct SearchIndex* ix = patchable_index(i);
+    if (!ix) return;
+    int n = ix->set->count + 1;     /* 删除前的条目数 */
+    int e = -1;
+    int kept = 0;
+    for (int k = 0; k < n; k++) {
+        int v = ix->order[k];
+        if (v == i) {
+            e = k;
+            continue;
+        }
+        ix->order[kept++] = v > i ? v - 1 : v;
+    }
+    if (e < 0) {
+        ix->built = 0;
+        return;
+    }
+
+    size_t w = 0;
+    for (size_t g = 0; g < ix->gram_count; g++) {
+        uint64_t v = ix->grams[g];
+        int entry = (int)(v & (MAX_ENTRIES - 1));
+        if (entry == e) continue;
+        ix->grams[w++] = entry > e ? v - 1 : v;
+    }
+    ix->gram_count = w;
+    ix->generation = questionCacheGeneration();
+}
+
+/**
+ * @brief 释放所有索引
+ */
+void searchClear(void) {
+    index_free(&indexes[0]);
+    index_free(&indexes[1]);
+}
@@ -0,0 +1,46 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "question_set.h"
+
+/*
+ * 题库与 CET4 词库的单词搜索：进程内索引，按需建立
+ * 单词按小写排序以支持前缀查找；单词与翻译中的单字节与相邻两字节各建一张倒排表（n-gram），
+ * 子串查找取关键字中倒排表最短的 n-gram，只核对其中的条目。按字节切分与核对，
+ * 与文本的编码无关（词库的释义由 dict.c 转换为 GBK 后建立索引）。ASCII 字母不区分大小写
+ * 题库索引跟随题库缓存（见 question_cache.h）：本进程增删单个题目时只更新该条目，
+ * 其他连接或进程修改题库、批量导入后在下一次搜索时重建；词库只读，只建立一次
+ */
+
+/* 搜索范围 */
+enum SearchSource {
+    SEARCH_QUESTIONS,   /* 题库 questions */
+    SEARCH_DICT         /* dict.db 中的 CET4 词库，结果的 qid 为 0 */
+};
+
+/* 匹配方式 */
+enum SearchMode {
+    SEARCH_PREFIX,      /* 单词以关键字开头 */
+    SEARCH_SUBSTRING,   /* 单词包含关键字 */
+    SEARCH_TRANSLATION  /* 翻译包含关键字（由中文释义反查单词） */
+};
+
+/*
+ * 搜索 source 中与 query 匹配的单词，按单词的字母顺序最多追加 limit 个到 out（需已初始化），limit <= 0 表示不限
+ * 返回追加的个数，出错返回 -1
+ */
+int searchWords(enum SearchSource source, enum SearchMode mode, const char* query, int limit, struct QuestionSet* out);
+
+/* 预先建立 source 的索引（否则在第一次搜索时建立），成功返回 1 */
+int searchBuild(enum SearchSource source);
+
+/* 题库缓存追加了下标为 i 的题目后调用（见 questionCacheAdded），i 为 -1 时什么也不做 */
+void searchQuestionAdded(int i);
+
+/* 题库缓存移除了原下标为 i 的题目后调用（见 questionCacheDeleted），i 为 -1 时什么也不做 */
+void searchQuestionRemoved(int i);
+
+/* 释放所有索引（关闭连接前由 dbClose 调用） */
+void searchClear(void);
+
+#endif /* SEARCH_H */
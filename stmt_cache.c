@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <string.h>
+#include "stmt_cache.h"
+#include "connection.h"
+#include "timer.h"
+
+/* 成绩统计的公共部分，u - users; s - student_stats（每个学生一行，无需再 GROUP BY） */
+#define GRADE_COLUMNS "SELECT u.uuid, u.username, u.class_name, u.student_num, s.total_score, s.total_questions, CAST(s.correct_count AS FLOAT) / s.total_questions FROM users u LEFT JOIN student_stats s ON s.student_uuid = u.uuid "
+
+#define EXPORT_COLUMNS "SELECT u.username, u.class_name, u.student_num, " \
+                       "COALESCE(s.total_score, 0) as total_score, " \
+                       "COALESCE(s.total_questions, 0) as question_count, " \
+                       "COALESCE(CAST(s.correct_count AS FLOAT) / NULLIF(s.total_questions, 0), 0.0) as accuracy " \
+                       "FROM users u " \
+                       "LEFT JOIN student_stats s ON s.student_uuid = u.uuid " \
+                       "WHERE u.user_level = 2 "
+
+static const char* const stmt_sql[STMT_COUNT] = {
+    [STMT_BEGIN]               = "BEGIN IMMEDIATE",
+    [STMT_COMMIT]              = "COMMIT",
+    [STMT_ROLLBACK]            = "ROLLBACK",
+    [STMT_USER_INSERT]         = "INSERT INTO users VALUES(?, ?, ?, ?, ?, ?, ?)",
+    [STMT_USER_LOGIN]          = "SELECT uuid, password_hash, user_level, class_name, student_num, teacher_uuid "
+                                 "FROM users WHERE username = ?",
+    [STMT_USER_LEVEL]          = "SELECT user_level FROM users WHERE uuid = ?",
+    [STMT_USER_DELETE]         = "DELETE FROM users WHERE uuid = ?",
+    /* 批量删除只删学生，与成绩查询一样走 idx_users_class / idx_users_level_num */
+    [STMT_USERS_DELETE_BY_CLASS]     = "DELETE FROM users WHERE class_name = ? AND user_level = 2",
+    [STMT_USERS_DELETE_BY_NUM_RANGE] = "DELETE FROM users WHERE user_level = 2 AND student_num BETWEEN ? AND ?",
+    [STMT_QUESTION_INSERT]     = "INSERT INTO questions (word, translate) VALUES (?, ?)",
+    [STMT_QUESTION_UPSERT]     = "INSERT INTO questions (word, translate) VALUES (?, ?) "
+                                 "ON CONFLICT(word) DO UPDATE SET translate = excluded.translate WHERE translate <> excluded.translate",
+    [STMT_QUESTION_DELETE]     = "DELETE FROM questions WHERE qid = ?",
+    [STMT_QUESTION_ALL_BY_QID] = "SELECT qid, word, translate FROM questions ORDER BY qid ASC",
+    [STMT_QUESTION_BY_QID]     = "SELECT qid, word, translate FROM questions WHERE qid = ?",
+    [STMT_QUESTION_QID_RANGE]  = "SELECT (SELECT MIN(qid) FROM questions), (SELECT MAX(qid) FROM questions)",
+    [STMT_QUESTION_WEIGHTS]    = "SELECT qid, difficulty FROM questions",
+    [STMT_QUESTION_BY_QID_DIFFICULTY] = "SELECT qid, word, translate FROM questions WHERE qid = ? AND difficulty = ?",
+    [STMT_QUESTION_IN_BUCKET]  = "SELECT qid FROM questions WHERE difficulty = ?",
+    /* 难度 = 1 + floor(答错率 * 5)，上限 5（DIFFICULTY_LEVELS）；答题次数不足 ? 次的题目保持不变 */
+    [STMT_DIFFICULTY_UPDATE]   = "UPDATE questions SET difficulty = d.level FROM ("
+                                 "SELECT qid, MIN(5, 1 + CAST((1.0 - AVG(is_correct)) * 5 AS INTEGER)) AS level "
+                                 "FROM answer_records WHERE qid IS NOT NULL AND is_correct IS NOT NULL "
+                                 "GROUP BY qid HAVING COUNT(*) >= ?) AS d "
+                                 "WHERE questions.qid = d.qid AND questions.difficulty IS NOT d.level",
+    [STMT_DATA_VERSION]        = "PRAGMA data_version",
+    [STMT_ANSWER_INSERT]       = "INSERT INTO answer_records (student_uuid, qid, user_answer, is_correct, score) VALUES (?, ?, ?, ?, ?)",
+    /*
+     * 以下成绩查询由菜单按 LIMIT / OFFSET 逐页读取，每页都是一次新的查询，
+     * 排序必须以唯一的列结尾，否则同分、同学号的行在页与页之间可能重复或遗漏
+     */
+    /*
+     * 按姓名包含查询的关键字以小写的 BLOB 绑定，按字节查找（不用 LIKE：LIKE 把 _ 与 % 当作通配符，
+     * 且按 UTF-8 解码 GBK 的姓名，会漏掉从名字中间的汉字开始的关键字）
+     */
+    [STMT_GRADES_BY_NAME]      = GRADE_COLUMNS "WHERE instr(CAST(lower(u.username) AS BLOB), ?) > 0 "
+                                 "ORDER BY u.username, u.uuid LIMIT ? OFFSET ?",
+    /*
+     * 关键字为两个字节时用两字节 n-gram，更长时取其中最少用户含有的三字节 n-gram（每个最多数到 1000），
+     * 只对这些用户按字节核对并读取成绩
+     */
+    [STMT_GRADES_BY_NAME_GRAMS] = GRADE_COLUMNS "WHERE u.uuid IN (SELECT uuid FROM username_grams WHERE gram = ("
+                                  "SELECT substr(?1, n, MIN(3, length(?1))) FROM gram_positions "
+                                  "WHERE n <= length(?1) - MIN(3, length(?1)) + 1 ORDER BY ("
+                                  "SELECT COUNT(*) FROM (SELECT 1 FROM username_grams g "
+                                  "WHERE g.gram = substr(?1, n, MIN(3, length(?1))) LIMIT 1000)"
+                                  ") LIMIT 1)) AND instr(CAST(lower(u.username) AS BLOB), ?1) > 0 "
+                                  "ORDER BY u.username, u.uuid LIMIT ? OFFSET ?",
+    [STMT_GRADES_BY_NAME_PREFIX] = GRADE_COLUMNS "WHERE u.username >= ?1 AND u.username < ?1 || CAST(x'ff' AS TEXT) "
+                                   "ORDER BY u.username LIMIT ? OFFSET ?",
+    [STMT_GRADES_BY_NAME_EXACT] = GRADE_COLUMNS "WHERE u.username = ? ORDER BY u.uuid LIMIT ? OFFSET ?",
+    [STMT_GRADES_BY_CLASS]     = GRADE_COLUMNS "WHERE u.class_name = ? AND u.user_level = 2 "
+                                 "ORDER BY s.total_score DESC, u.student_num, u.uuid LIMIT ? OFFSET ?",
+    [STMT_GRADES_BY_NUM_RANGE] = GRADE_COLUMNS "WHERE u.student_num >= ? AND u.student_num <= ? AND u.user_level = 2 "
+                                 "ORDER BY u.student_num ASC, u.uuid LIMIT ? OFFSET ?",
+    [STMT_STATS_CLEAR]         = "DELETE FROM student_stats",
+    [STMT_STATS_REBUILD]       = "INSERT INTO student_stats (student_uuid, total_score, total_questions, correct_count) "
+                                 "SELECT student_uuid, COALESCE(SUM(score), 0), COUNT(*), COALESCE(SUM(is_correct), 0) "
+                                 "FROM answer_records WHERE student_uuid IS NOT NULL GROUP BY student_uuid",
+    [STMT_CLASS_LIST]          = "SELECT DISTINCT class_name FROM users WHERE class_name IS NOT NULL AND class_name != '' ORDER BY class_name",
+    [STMT_EXPORT_BY_SCORE]     = EXPORT_COLUMNS "ORDER BY total_score DESC, u.student_num ASC",
+    [STMT_EXPORT_BY_CLASS]     = EXPORT_COLUMNS "ORDER BY u.class_name ASC, total_score DESC",
+    [STMT_REVIEW_DUE]          = "SELECT q.qid, q.word, q.translate FROM review_state r JOIN questions q ON q.qid = r.qid "
+                                 "WHERE r.student_uuid = ? AND r.due_at <= ? ORDER BY r.due_at LIMIT ?",
+};
+
+static sqlite3_stmt* cache[STMT_COUNT];
+static struct StmtCacheStats stats;
+
+/**
+ * @brief 取得已缓存的语句，首次使用时惰性准备
+ * @param id 语句编号
+ * @return 已重置、可直接绑定参数的语句；失败返回 NULL
+ */
+sqlite3_stmt* stmtGet(enum StmtId id) {
+    if ((int)id < 0 || id >= STMT_COUNT) return NULL;
+
+    if (cache[id]) {
+        /* 调用方若忘记 stmtRelease，这里兜底重置一次 */
+        sqlite3_reset(cache[id]);
+        stats.hits++;
+        return cache[id];
+    }
+
+    sqlite3* db = dbGet();
+    if (!db) return NULL;
+
+    long long start = timerNowNs();
+    int rc = sqlite3_prepare_v3(db, stmt_sql[id], -1, SQLITE_PREPARE_PERSISTENT, &cache[id], NULL);
+    stats.prepare_ns += timerNowNs() - start;
+    stats.misses++;
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "[ERROR] Prepare SQL failed: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(cache[id]);
+        cache[id] = NULL;
+        return NULL;
+    }
+    return cache[id];
+}
+
+const char* stmtSql(enum StmtId id) {
+    if ((int)id < 0 || id >= STMT_COUNT) return NULL;
+    return stmt_sql[id];
+}
+
+/**
+ * @brief 归还语句：重置并清除绑定，避免长期持有读事务或悬空的参数指针
+ */
+void stmtRelease(sqlite3_stmt* stmt) {
+    if (!stmt) return;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+/**
+ * @brief 销毁全部缓存语句
+ */
+void stmtCacheClear(void) {
+    for (int i = 0; i < STMT_COUNT; i++) {
+        if (cache[i]) {
+            sqlite3_finalize(cache[i]);
+            cache[i] = NULL;
+        }
+    }
+}
+
+void stmtCacheGetStats(struct StmtCacheStats* out) {
+    if (out) *out = stats;
+}
+
+void stmtCacheResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
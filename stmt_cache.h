@@ -0,0 +1,69 @@
+#ifndef STMT_CACHE_H
+#define STMT_CACHE_H
+
+#include "lib/sqlite3.h"
+
+/* 所有固定 SQL 语句的编号，对应的 SQL 文本见 stmt_cache.c */
+enum StmtId {
+    STMT_BEGIN,
+    STMT_COMMIT,
+    STMT_ROLLBACK,
+    STMT_USER_INSERT,
+    STMT_USER_LOGIN,
+    STMT_USER_LEVEL,
+    STMT_USER_DELETE,
+    STMT_USERS_DELETE_BY_CLASS,
+    STMT_USERS_DELETE_BY_NUM_RANGE,
+    STMT_QUESTION_INSERT,
+    STMT_QUESTION_UPSERT,
+    STMT_QUESTION_DELETE,
+    STMT_QUESTION_ALL_BY_QID,
+    STMT_QUESTION_BY_QID,
+    STMT_QUESTION_QID_RANGE,
+    STMT_QUESTION_WEIGHTS,
+    STMT_QUESTION_BY_QID_DIFFICULTY,
+    STMT_QUESTION_IN_BUCKET,
+    STMT_DIFFICULTY_UPDATE,
+    STMT_DATA_VERSION,
+    STMT_ANSWER_INSERT,
+    STMT_GRADES_BY_NAME,
+    STMT_GRADES_BY_NAME_GRAMS,
+    STMT_GRADES_BY_NAME_PREFIX,
+    STMT_GRADES_BY_NAME_EXACT,
+    STMT_GRADES_BY_CLASS,
+    STMT_GRADES_BY_NUM_RANGE,
+    STMT_STATS_CLEAR,
+    STMT_STATS_REBUILD,
+    STMT_CLASS_LIST,
+    STMT_EXPORT_BY_SCORE,
+    STMT_EXPORT_BY_CLASS,
+    STMT_REVIEW_DUE,
+    STMT_COUNT
+};
+
+/* 语句缓存的统计数据 */
+struct StmtCacheStats {
+    long long hits;        /* 直接复用已准备语句的次数 */
+    long long misses;      /* 首次使用而需要准备语句的次数 */
+    long long prepare_ns;  /* 准备语句累计耗时（纳秒） */
+};
+
+/*
+ * 取得编号为 id 的语句：首次使用时在共享连接上准备，之后直接复用
+ * 失败返回 NULL。用完后必须调用 stmtRelease
+ */
+sqlite3_stmt* stmtGet(enum StmtId id);
+
+/* 返回编号对应的 SQL 文本 */
+const char* stmtSql(enum StmtId id);
+
+/* 重置语句并清除绑定参数，释放语句持有的读锁 */
+void stmtRelease(sqlite3_stmt* stmt);
+
+/* 销毁所有已缓存的语句（关闭连接前由 dbClose 调用） */
+void stmtCacheClear(void);
+
+void stmtCacheGetStats(struct StmtCacheStats* out);
+void stmtCacheResetStats(void);
+
+#endif /* STMT_CACHE_H */
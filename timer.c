@@ -0,0 +1,37 @@
+#include "timer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+long long timerNowNs(void) {
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    /* 先除后乘，避免计数值较大时溢出 */
+    return (long long)(now.QuadPart / freq.QuadPart) * 1000000000LL
+         + (long long)(now.QuadPart % freq.QuadPart) * 1000000000LL / freq.QuadPart;
+}
+
+long long timerUnixMs(void) {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    /* FILETIME 以 100 纳秒为单位，从 1601-01-01 起算 */
+    long long t = ((long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (t - 116444736000000000LL) / 10000;
+}
+#else
+#include <time.h>
+
+long long timerNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+long long timerUnixMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+#endif
@@ -0,0 +1,10 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+/* 返回单调时钟的当前时间（纳秒），用于性能统计与基准测试 */
+long long timerNowNs(void);
+
+/* 返回自 1970-01-01 UTC 起的毫秒数（墙上时钟），用于 UUIDv7 的时间戳 */
+long long timerUnixMs(void);
+
+#endif /* TIMER_H */
@@ -0,0 +1,206 @@
+#ifdef _WIN32
+#define _CRT_RAND_S     /* 使 stdlib.h 声明 rand_s */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include "uuid.h"
+#include "timer.h"
+#include "lib/sqlite3.h"
+
+/* xoshiro256** 状态，全为 0 表示尚未播种 */
+static unsigned long long rng_state[4];
+
+/* 上一个 UUIDv7 的时间戳与计数器 */
+static long long v7_last_ms = -1;
+static unsigned int v7_counter = 0;
+
+/* 工作线程也可能生成 UUID，状态由该互斥锁保护（连接池使用 APP1） */
+static sqlite3_mutex* uuid_mutex(void) {
+    return sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_APP2);
+}
+
+static unsigned long long rotl(unsigned long long x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/* 用 splitmix64 把种子扩展为 xoshiro 的 4 个状态字 */
+static unsigned long long splitmix64(unsigned long long* x) {
+    unsigned long long z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief 从系统熵源读取 8 字节，失败时退回到时间与地址的混合
+ */
+static unsigned long long entropy64(void) {
+    unsigned long long seed = 0;
+#ifdef _WIN32
+    unsigned int lo = 0, hi = 0;
+    if (rand_s(&lo) == 0 && rand_s(&hi) == 0) {
+        return ((unsigned long long)hi << 32) | lo;
+    }
+#else
+    FILE* f = fopen("/dev/urandom", "rb");
+    if (f) {
+        size_t n = fread(&seed, sizeof(seed), 1, f);
+        fclose(f);
+        if (n == 1) return seed;
+    }
+#endif
+    seed = (unsigned long long)timerNowNs() ^ ((unsigned long long)timerUnixMs() << 20);
+    return seed ^ (unsigned long long)(size_t)&seed;
+}
+
+static void seed_once(void) {
+    if (rng_state[0] | rng_state[1] | rng_state[2] | rng_state[3]) return;
+    unsigned long long x = entropy64();
+    for (int i = 0; i < 4; i++) rng_state[i] = splitmix64(&x);
+}
+
+/* 调用者需持有 uuid_mutex */
+static unsigned long long next_locked(void) {
+    seed_once();
+    unsigned long long* s = rng_state;
+    unsigned long long result = rotl(s[1] * 5, 7) * 9;
+    unsigned long long t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+unsigned long long uuidRandom64(void) {
+    sqlite3_mutex* m = uuid_mutex();
+    sqlite3_mutex_enter(m);
+    unsigned long long r = next_locked();
+    sqlite3_mutex_leave(m);
+    return r;
+}
+
+void uuidFormat(const unsigned char b[16], char out[UUID_STR_LEN]) {
+    static const char hex[] = "0123456789abcdef";
+    int pos = 0;
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) out[pos++] = '-';
+        out[pos++] = hex[b[i] >> 4];
+        out[pos++] = hex[b[i] & 0x0F];
+    }
+    out[pos] = '\0';
+}
+
+static void put64(unsigned char* b, unsigned long long v) {
+    for (int i = 0; i < 8; i++) b[i] = (unsigned char)(v >> (56 - 8 * i));
+}
+
+void uuidV4(char out[UUID_STR_LEN]) {
+    unsigned char b[16];
+    sqlite3_mutex* m = uuid_mutex();
+    sqlite3_mutex_enter(m);
+    put64(b, next_locked());
+    put64(b + 8, next_locked());
+    sqlite3_mutex_leave(m);
+    b[6] = (b[6] & 0x0F) | 0x40;    /* version 4 */
+    b[8] = (b[8] & 0x3F) | 0x80;    /* variant 10 */
+    uuidFormat(b, out);
+}
+
+void uuidV7(char out[UUID_STR_LEN]) {
+    unsigned char b[16];
+    sqlite3_mutex* m = uuid_mutex();
+    sqlite3_mutex_enter(m);
+    long long ms = timerUnixMs();
+    if (ms > v7_last_ms) {
+        /* 新的一毫秒：计数器从随机值开始，最高位留 0 以留出递增空间 */
+        v7_last_ms = ms;
+        v7_counter = (unsigned int)(next_locked() & 0x7FF);
+    } else if (++v7_counter > 0xFFF) {
+        /* 计数器用尽或时钟回拨：借用下一毫秒，保持单调递增 */
+        v7_last_ms++;
+        v7_counter = (unsigned int)(next_locked() & 0x7FF);
+    }
+    ms = v7_last_ms;
+    unsigned int counter = v7_counter;
+    unsigned long long rand_b = next_locked();
+    sqlite3_mutex_leave(m);
+
+    put64(b, (unsigned long long)ms << 16);
+    b[6] = (unsigned char)(0x70 | (counter >> 8));   /* version 7 与计数器高 4 位 */
+    b[7] = (unsigned char)(counter & 0xFF);
+    put64(b + 8, rand_b);
+    b[8] = (b[8] & 0x3F) | 0x80;
+    uuidFormat(b, out);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int uuidParse(const char* text, unsigned char b[16]) {
+    if (!text) return 0;
+    int pos = 0;
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            if (text[pos++] != '-') return 0;
+        }
+        int hi = hex_value(text[pos]);
+        int lo = hi < 0 ? -1 : hex_value(text[pos + 1]);
+        if (lo < 0) return 0;
+        b[i] = (unsigned char)(hi << 4 | lo);
+        pos += 2;
+    }
+    return text[pos] == '\0';
+}
+
+int uuidBind(sqlite3_stmt* stmt, int index, const char* text) {
+    unsigned char b[16];
+    if (!uuidParse(text, b)) return sqlite3_bind_null(stmt, index);
+    return sqlite3_bind_blob(stmt, index, b, 16, SQLITE_TRANSIENT);
+}
+
+int uuidColumn(sqlite3_stmt* stmt, int col, char out[UUID_STR_LEN]) {
+    const unsigned char* b = (const unsigned char*)sqlite3_column_blob(stmt, col);
+    if (!b || sqlite3_column_bytes(stmt, col) != 16) {
+        out[0] = '\0';
+        return 0;
+    }
+    uuidFormat(b, out);
+    return 1;
+}
+
+/* uuid_blob(text)：格式错误或非文本时返回 NULL（unhex(text, '-') 不检查长度与连字符的位置） */
+static void sql_uuid_blob(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    (void)argc;
+    unsigned char b[16];
+    if (sqlite3_value_type(argv[0]) == SQLITE_TEXT && uuidParse((const char*)sqlite3_value_text(argv[0]), b)) {
+        sqlite3_result_blob(ctx, b, 16, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_result_null(ctx);
+    }
+}
+
+/* uuid_text(blob)：长度不为 16 时返回 NULL */
+static void sql_uuid_text(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    (void)argc;
+    const unsigned char* b = (const unsigned char*)sqlite3_value_blob(argv[0]);
+    if (sqlite3_value_type(argv[0]) == SQLITE_BLOB && sqlite3_value_bytes(argv[0]) == 16) {
+        char out[UUID_STR_LEN];
+        uuidFormat(b, out);
+        sqlite3_result_text(ctx, out, 36, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_result_null(ctx);
+    }
+}
+
+int uuidRegisterFunctions(sqlite3* db) {
+    int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+    return sqlite3_create_function(db, "uuid_blob", 1, flags, NULL, sql_uuid_blob, NULL, NULL) == SQLITE_OK
+        && sqlite3_create_function(db, "uuid_text", 1, flags, NULL, sql_uuid_text, NULL, NULL) == SQLITE_OK;
+}
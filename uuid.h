@@ -0,0 +1,42 @@
+#ifndef UUID_H
+#define UUID_H
+
+#include "lib/sqlite3.h"
+
+/* UUID 字符串长度（含终止符） */
+#define UUID_STR_LEN 37
+
+/*
+ * 进程内共享的伪随机数（xoshiro256**），首次使用时从系统熵源播种一次
+ * （Windows 为 rand_s，其他系统为 /dev/urandom）
+ */
+unsigned long long uuidRandom64(void);
+
+/* 随机 UUID（version 4） */
+void uuidV4(char out[UUID_STR_LEN]);
+
+/*
+ * 按时间排序的 UUID（version 7，RFC 9562）：前 48 位为毫秒时间戳，
+ * 同一毫秒内的 12 位计数器递增，因此同一进程生成的 UUID 严格递增，
+ * 作为主键插入时总是落在 B 树的最右侧
+ */
+void uuidV7(char out[UUID_STR_LEN]);
+
+/* 将 16 字节格式化为 8-4-4-4-12 形式的小写十六进制字符串 */
+void uuidFormat(const unsigned char bytes[16], char out[UUID_STR_LEN]);
+
+/* 解析 8-4-4-4-12 形式的字符串（大小写均可），格式正确返回 1 */
+int uuidParse(const char* text, unsigned char bytes[16]);
+
+/*
+ * 数据库中 UUID 以 16 字节 BLOB 存储，只在接口处与字符串互相转换
+ * uuidBind 把字符串形式的 UUID 绑定为 BLOB，text 为 NULL 或格式错误时绑定 NULL
+ * uuidColumn 把 BLOB 列格式化为字符串，列为 NULL 或长度不为 16 时输出空串并返回 0
+ */
+int uuidBind(sqlite3_stmt* stmt, int index, const char* text);
+int uuidColumn(sqlite3_stmt* stmt, int col, char out[UUID_STR_LEN]);
+
+/* 在连接上注册 SQL 函数 uuid_blob(text) 与 uuid_text(blob)，供迁移与调试使用 */
+int uuidRegisterFunctions(sqlite3* db);
+
+#endif /* UUID_H */